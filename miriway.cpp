@@ -17,15 +17,19 @@
  */
 
 #include "miriway_app_switcher.h"
+#include "miriway_app_freezer.h"
 #include "miriway_child_control.h"
 #include "miriway_commands.h"
 #include "miriway_documenting_store.h"
+#include "miriway_input_event.h"
+#include "miriway_input_recording.h"
+#include "miriway_keyboard_shortcuts_inhibit_v1.h"
+#include "miriway_latency.h"
 #include "miriway_magnifier.h"
 #include "miriway_policy.h"
+#include "miriway_shortcuts.h"
 #include "miriway_ext_workspace_v1.h"
 
-#include <mir/abnormal_exit.h>
-#include <mir/fatal.h>
 #include <miral/append_event_filter.h>
 #include <miral/bounce_keys.h>
 #include <miral/config_file.h>
@@ -54,6 +58,8 @@
 
 #include <mir/log.h>
 
+#include <xkbcommon/xkbcommon-keysyms.h>
+
 #include <cstring>
 #include <filesystem>
 #include <format>
@@ -68,29 +74,6 @@ using namespace miriway;
 
 namespace
 {
-auto to_key(std::string_view as_string) -> xkb_keysym_t
-{
-    if (auto const result = xkb_keysym_from_name(as_string.data(), XKB_KEYSYM_CASE_INSENSITIVE); result != XKB_KEY_NoSymbol)
-    {
-        return result;
-    }
-
-    throw mir::AbnormalExit((std::string{ "Unrecognised key in config: "} + as_string.data()).c_str());
-}
-
-std::map<std::string, ShellCommands::CmdFunctor> const wm_command =
-    {
-        { "dock-left", [](ShellCommands* sc, bool shift) { sc->dock_active_window_left(shift); } },
-        { "dock-right", [](ShellCommands* sc, bool shift) { sc->dock_active_window_right(shift); } },
-        { "toggle-maximized", [](ShellCommands* sc, bool shift) { sc->toggle_maximized_restored(shift); } },
-        { "toggle-always-on-top", [](ShellCommands* sc, bool shift) { sc->toggle_always_on_top(shift); } },
-        { "workspace-begin", [](ShellCommands* sc, bool shift) { sc->workspace_begin(shift); } },
-        { "workspace-end", [](ShellCommands* sc, bool shift) { sc->workspace_end(shift); } },
-        { "workspace-up", [](ShellCommands* sc, bool shift) { sc->workspace_up(shift); } },
-        { "workspace-down", [](ShellCommands* sc, bool shift) { sc->workspace_down(shift); } },
-        { "exit", [](ShellCommands* sc, bool shift) { sc->exit(shift); } },
-    };
-
 // Build a list of shell components from "<commands>" values and launch them all after startup
 struct ShellComponents
 {
@@ -164,71 +147,35 @@ private:
     IdleListener idle_listener;
 };
 
-// Build an index of commands from "<key>:<commands>" values and launch them by <key> (if found)
-class CommandIndex
+// Apply the "keymap" setting. Compiling a keymap (for every keyboard) is expensive, so only do
+// that when the setting actually changes, not every time the settings file is reloaded.
+class KeymapSetting
 {
 public:
-    CommandIndex(
-        live_config::Store& store,
-        std::string const& option,
-        std::string const& description,
-        std::function<void(std::vector<std::string> const&)> launch) :
-        launch{std::move(launch)}
-    {
-        auto settings_key = option;
-        std::replace(settings_key.begin(), settings_key.end(), '-', '_');
-        store.add_strings_attribute(
-            live_config::Key{{"command", settings_key}},
-            "command " + description,
-            [this](live_config::Key const&, std::optional<std::span<std::string const>> value)
-            {
-                commands.clear();
-                if (value) populate(std::vector<std::string>(value->begin(), value->end()));
-            });
-    }
-
-    bool try_command_for(xkb_keysym_t key_code, bool with_shift, ShellCommands* cmd) const
-    {
-        auto const i = commands.find(xkb_keysym_to_lower(key_code));
-        bool const found = i != end(commands);
-        if (found) i->second(cmd, with_shift);
-        return found;
-    }
-
-private:
-    std::function<void (std::vector<std::string> const& command_line)> const launch;
-    mutable std::map<xkb_keysym_t, ShellCommands::CmdFunctor> commands;
-
-    void populate(std::vector<std::string> const& config_cmds) const
+    KeymapSetting(live_config::Store& store, Keymap& keymap) :
+        keymap{keymap}
     {
-        for (auto const& command : config_cmds)
-        {
-            if (auto const split = command.find(':'); split >= 1 && split+1 < command.size())
+        store.add_string_attribute(
+            live_config::Key{"keymap"},
+            "Keymap in the form <layout>[+<variant>[+<options>]] (e.g. \"gb\" or \"us+dvorak\")",
+            [this](live_config::Key const&, std::optional<std::string_view> value)
             {
-                auto const key = xkb_keysym_to_lower(to_key(command.substr(0, split)));
+                if (!value && !current)
+                    return;     // Never set: leave the default alone
 
-                if (command[split+1] != '@')
+                std::string const requested{value.value_or(default_keymap)};
+                if (requested != current)
                 {
-                    commands[key] =
-                        [this, argv = ExternalClientLauncher::split_command(command.substr(split+1))](miriway::ShellCommands*, bool)
-                        {
-                            launch(argv);
-                        };
-                }
-                else
-                {
-                    if (auto const lookup = wm_command.find(command.substr(split+2)); lookup != std::end(wm_command))
-                    {
-                        commands[key] = lookup->second;
-                    }
+                    current = requested;
+                    this->keymap.set_keymap(requested);
                 }
-            }
-            else
-            {
-                mir::fatal_error("Invalid command option: %s", command.c_str());
-            }
-        }
+            });
     }
+
+private:
+    static constexpr char const* default_keymap = "us";
+    Keymap& keymap;
+    std::optional<std::string> current;
 };
 
 inline auto config_path(std::filesystem::path path)
@@ -454,11 +401,17 @@ int main(int argc, char const* argv[])
 
     ChildControl child_control(runner);
 
+    // `kill -USR2` dumps the keypress-to-action latency histograms to $XDG_RUNTIME_DIR/miriway-latency
+    latency::DumpOnSignal const latency_dump{runner};
+
     WaylandTools wltools;
 
     extensions.add_extension_disabled_by_default(build_ext_workspace_v1_global(wltools));
     child_control.enable_for_shell(extensions, ext_workspace_v1_name());
 
+    // Available to apps (e.g. VM viewers and remote desktops) if enabled with "add-wayland-extensions"
+    extensions.add_extension_disabled_by_default(build_keyboard_shortcuts_inhibit_v1_global());
+
     // Protocols we're reserving for shell components_option
     for (auto const& protocol : {
         WaylandExtensions::zwlr_layer_shell_v1,
@@ -497,66 +450,91 @@ int main(int argc, char const* argv[])
     CursorScale cursor_scale{*settings_store};
     OutputFilter output_filter{*settings_store};
 
-    Magnifier magnifier{*settings_store};
+    Magnifier magnifier{runner, *settings_store};
+    AppFreezer app_freezer{runner, *settings_store};
     InputConfiguration input_configuration{*settings_store};
+
+    // These only hook into Mir's accessibility manager: it adds each input transformer to the
+    // event path when its "enable" setting turns it on (and removes it when turned off)
     BounceKeys bounce_keys{*settings_store};
     SlowKeys slow_keys{*settings_store};
     StickyKeys sticky_keys{*settings_store};
     HoverClick hover_click{*settings_store};
 
-    // Register shell command options with the settings store
-    // corresponding configuration options. These processes are added to `shell_pids`
-    CommandIndex shell_meta{
+    // Register shell command options with the settings store. Commands launched from the "shell-*"
+    // options are added to `shell_pids`, the others are NOT
+    // Replaying a recording doesn't launch the applications its shortcuts name, unless asked to
+    bool const launch_enabled = !getenv("MIRIWAY_REPLAY_INPUT") || getenv("MIRIWAY_REPLAY_LAUNCH");
+
+    Shortcuts shortcuts{
+        *settings_store,
+        [&child_control, launch_enabled](auto const& cmd, bool shell) -> pid_t
+        {
+            if (!launch_enabled)
+                return 0;
+
+            if (shell)
+                return child_control.run_shell(cmd);
+            else
+                return child_control.run_app(cmd);
+        },
+        [&child_control](auto const& cmd) { child_control.resolve_executable(cmd); }};
+
+    using enum ShellCommands::Modifiers;
+    shortcuts.add_source(
         *settings_store,
         "shell-meta",
         "meta <key>:<command> shortcut with shell privileges (may be specified multiple times)",
-        [&child_control](auto cmd) { child_control.run_shell(cmd); }};
+        meta, true);
 
-    CommandIndex shell_ctrl_alt{
+    shortcuts.add_source(
         *settings_store,
         "shell-ctrl-alt",
         "ctrl-alt <key>:<command> shortcut with shell privileges (may be specified multiple times)",
-        [&child_control](auto cmd) { child_control.run_shell(cmd); }};
+        ctrl_alt, true);
 
-    CommandIndex shell_alt{
+    shortcuts.add_source(
         *settings_store,
         "shell-alt",
         "alt <key>:<command> shortcut with shell privileges (may be specified multiple times)",
-        [&child_control](auto cmd) { child_control.run_shell(cmd); }};
+        alt, true);
 
-    // `meta`, `alt` and `ctrl_alt` provide a lookup to execute the commands configured by the corresponding
-    // configuration options. These processes are NOT added to `shell_pids`
-    CommandIndex meta{
+    shortcuts.add_source(
         *settings_store,
         "meta",
         "meta <key>:<command> shortcut (may be specified multiple times)",
-        [&](auto cmd) { child_control.run_app(cmd); }};
+        meta, false);
 
-    CommandIndex ctrl_alt{
+    shortcuts.add_source(
         *settings_store,
         "ctrl-alt",
         "ctrl-alt <key>:<command> shortcut (may be specified multiple times)",
-        [&](auto cmd) { child_control.run_app(cmd); }};
+        ctrl_alt, false);
 
-    CommandIndex alt{
+    shortcuts.add_source(
         *settings_store,
         "alt",
         "alt <key>:<command> shortcut (may be specified multiple times)",
-        [&](auto cmd) { child_control.run_app(cmd); }};
+        alt, false);
 
-    CommandIndex shell_plain{
+    shortcuts.add_source(
         *settings_store,
         "shell-plain",
         "unmodified <key>:<command> shortcut with shell privileges (may be specified multiple times)",
-        [&child_control](auto cmd) { child_control.run_shell(cmd); }};
+        plain, true);
 
-    CommandIndex plain{
+    shortcuts.add_source(
         *settings_store,
         "plain",
         "unmodified <key>:<command> shortcut (may be specified multiple times)",
-        [&](auto cmd) { child_control.run_app(cmd); }};
+        plain, false);
 
-    Keymap keymap = getenv("MIRIWAY_SYSTEM_LOCALE1_KEYMAP") ? Keymap::system_locale1() : Keymap{*settings_store};
+    Keymap keymap = getenv("MIRIWAY_SYSTEM_LOCALE1_KEYMAP") ? Keymap::system_locale1() : Keymap{};
+    std::optional<KeymapSetting> keymap_setting;
+    if (!getenv("MIRIWAY_SYSTEM_LOCALE1_KEYMAP"))
+    {
+        keymap_setting.emplace(*settings_store, keymap);
+    }
     settings_store.reset();
 
     ConfigFile config_file{
@@ -568,12 +546,10 @@ int main(int argc, char const* argv[])
     // Process input events to identifies commands Miriway needs to handle
     ShellCommands commands{
         runner,
-        [&] (xkb_keysym_t c, bool s, ShellCommands* cmd) { return shell_meta.try_command_for(c, s, cmd) || meta.try_command_for(c, s, cmd); },
-        [&] (xkb_keysym_t c, bool s, ShellCommands* cmd) { return shell_ctrl_alt.try_command_for(c, s, cmd) || ctrl_alt.try_command_for(c, s, cmd); },
-        [&] (xkb_keysym_t c, bool s, ShellCommands* cmd) { return shell_alt.try_command_for(c, s, cmd) || alt.try_command_for(c, s, cmd); },
-        [&] (xkb_keysym_t c, bool s, ShellCommands* cmd) { return shell_plain.try_command_for(c, s, cmd) || plain.try_command_for(c, s, cmd); }};
+        [&] (auto mods, xkb_keysym_t c, bool s, ShellCommands* cmd) { return shortcuts.try_command_for(mods, c, s, cmd); },
+        [&] (Application const& app) { shortcuts.advise_window_for(pid_of(app)); }};
 
-    AppSwitcher app_switcher;
+    AppSwitcher app_switcher{commands};
 
     std::atomic<bool> is_locked = false;
     LockScreen lockscreen(
@@ -582,6 +558,86 @@ int main(int argc, char const* argv[])
         [&extensions, &child_control](auto protocol) {
             child_control.enable_for_shell(extensions, protocol); });
 
+    // The key of a Ctrl-Alt-Delete escape from shortcut inhibition, until it is released
+    std::optional<int> inhibit_escape_key;
+
+    // Route input events to the interested consumers
+    auto const route_input = [&](InputEvent const& event)
+        {
+            // The client didn't get the escape's key down, so mustn't get its key up
+            if (inhibit_escape_key && event.type == InputEvent::Type::key &&
+                event.key_action == mir_keyboard_action_up && event.scan_code == *inhibit_escape_key)
+            {
+                inhibit_escape_key.reset();
+                return true;
+            }
+
+            // While the focused window inhibits shortcuts it gets everything, except the Ctrl-Alt-Delete escape
+            if (keyboard_shortcuts_inhibited())
+            {
+                auto const ctrl_alt = mir_input_event_modifier_alt | mir_input_event_modifier_ctrl;
+                if (event.is_key_down() && event.keysym == XKB_KEY_Delete && (event.modifiers & ctrl_alt) == ctrl_alt)
+                {
+                    keyboard_shortcuts_inhibit_escape();
+                    inhibit_escape_key = event.scan_code;
+                    return true;
+                }
+                return false;
+            }
+
+            switch (event.type)
+            {
+            case InputEvent::Type::key:
+            case InputEvent::Type::pointer:
+            case InputEvent::Type::touch:
+                break;
+
+            default:
+                return false;   // Nothing here is interested in anything else
+            }
+
+            if (magnifier.process_zoom_scroll(event))
+                return true;
+
+            if (!is_locked)
+            {
+                if (commands.shell_keyboard_enabled() && app_switcher.process_event(event))
+                    return true;
+                if (commands.input_event(event))
+                    return true;
+            }
+            return magnifier.process_event(event);
+        };
+
+    auto const filter_input = [&](InputEvent const& event)
+        {
+            auto const consumed = route_input(event);
+            commands.input_processed(event, consumed);
+            return consumed;
+        };
+
+    std::optional<InputRecorder> input_recorder;
+    if (auto const file = getenv("MIRIWAY_RECORD_INPUT"))
+    {
+        input_recorder.emplace(file);
+    }
+
+    if (auto const file = getenv("MIRIWAY_REPLAY_INPUT"))
+    {
+        runner.add_start_callback([&runner, &commands, &filter_input, file=std::string{file}]
+            {
+                // Replay blocks the main loop, so execute the commands each event posts before the
+                // next (otherwise they accumulate until the queue overflows)
+                replay_input(file, [&](InputEvent const& event)
+                    {
+                        auto const consumed = filter_input(event);
+                        commands.execute_queued_commands();
+                        return consumed;
+                    });
+                runner.stop();
+            });
+    }
+
     runner.add_start_callback([&child_control]
         {
             if (auto const miriway_session_startup = getenv("MIRIWAY_SESSION_STARTUP"))
@@ -608,16 +664,16 @@ int main(int argc, char const* argv[])
             components_option,
             keymap,
             AppendEventFilter{[&](MirEvent const* e) {
-                if (is_locked)
-                    return false;
-                if (commands.shell_keyboard_enabled() && app_switcher.process_event(e))
-                    return true;
-                return commands.input_event(e);
+                // Decode the event once, and route it to the interested consumers
+                InputEvent const event{e};
+                if (input_recorder)
+                    input_recorder->record(event);
+                return filter_input(event);
             }},
             SessionLockListener(
                 [&] { is_locked = true; },
                 [&] { is_locked = false; }),
-            set_window_management_policy<WindowManagerPolicy>(commands),
+            set_window_management_policy<WindowManagerPolicy>(commands, app_freezer),
             lockscreen,
             getenv_decorations(),
             CursorTheme{"default"},
@@ -630,6 +686,5 @@ int main(int argc, char const* argv[])
             sticky_keys,
             hover_click,
             magnifier,
-            app_switcher,
         });
 }
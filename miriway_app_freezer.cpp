@@ -0,0 +1,367 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_app_freezer.h"
+
+#include <miral/application.h>
+
+#include <mir/log.h>
+
+#include <signal.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace
+{
+int constexpr default_hidden_for_seconds = 0;
+int constexpr default_pressure_threshold = 10;
+
+// PSI averages are updated every couple of seconds, so there's no point in checking more often
+auto constexpr check_interval = std::chrono::seconds{2};
+
+// The "some avg10" figure from /proc/pressure/memory: the percentage of the last ten seconds
+// in which at least one task was stalled waiting for memory
+auto memory_pressure() -> std::optional<double>
+{
+    std::ifstream psi{"/proc/pressure/memory"};
+    std::string some;
+    std::string avg10;
+    if (psi >> some >> avg10 && some == "some" && avg10.starts_with("avg10="))
+    {
+        return std::strtod(avg10.c_str() + 6, nullptr);
+    }
+
+    return std::nullopt;
+}
+
+// The cgroup v2 path of `proc` (a pid or "self"), empty if it isn't known
+auto cgroup_of(std::string const& proc) -> std::filesystem::path
+{
+    std::ifstream file{"/proc/" + proc + "/cgroup"};
+    for (std::string line; std::getline(file, line);)
+    {
+        if (line.starts_with("0::"))
+        {
+            return line.substr(3);
+        }
+    }
+
+    return {};
+}
+
+auto command_of(pid_t pid) -> std::string
+{
+    std::ifstream file{"/proc/" + std::to_string(pid) + "/comm"};
+    std::string result;
+    std::getline(file, result);
+    return result;
+}
+
+auto write_to(std::filesystem::path const& file, char const* value) -> bool
+{
+    std::ofstream out{file};
+    out << value << std::flush;
+    return static_cast<bool>(out);
+}
+}
+
+miriway::AppFreezer::AppFreezer(MirRunner& runner, live_config::Store& store) :
+    hidden_for{default_hidden_for_seconds},
+    pressure_threshold{default_pressure_threshold},
+    own_cgroup{cgroup_of("self")}
+{
+    store.add_int_attribute(
+        live_config::Key{{"freeze", "hidden_after"}},
+        "Seconds an app's windows must all have been on hidden workspaces before it may be frozen "
+        "under memory pressure (0 disables freezing). Note: a frozen app can be disconnected if "
+        "its Wayland connection backs up, and cannot serve clipboard or drag and drop transfers",
+        default_hidden_for_seconds,
+        [this](live_config::Key const& key, std::optional<int> value)
+        {
+            if (value && *value < 0)
+            {
+                mir::log_warning("Config value %s is negative, ignoring", key.to_string().c_str());
+                return;
+            }
+
+            std::lock_guard lock{mutex};
+            hidden_for = std::chrono::seconds{value.value_or(default_hidden_for_seconds)};
+            update_timer();
+        });
+
+    store.add_int_attribute(
+        live_config::Key{{"freeze", "memory_pressure"}},
+        "Memory pressure (the percentage of time stalled on memory, from /proc/pressure/memory) "
+        "at which hidden apps are frozen",
+        default_pressure_threshold,
+        [this](live_config::Key const& key, std::optional<int> value)
+        {
+            if (value && (*value < 1 || *value > 100))
+            {
+                mir::log_warning("Config value %s must be between 1 and 100, ignoring", key.to_string().c_str());
+                return;
+            }
+
+            std::lock_guard lock{mutex};
+            pressure_threshold = value.value_or(default_pressure_threshold);
+        });
+
+    runner.add_start_callback([this, &runner]
+        {
+            auto const fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+            if (fd == -1)
+            {
+                mir::log_warning("timerfd_create failed, hidden apps will not be frozen");
+                return;
+            }
+
+            std::lock_guard lock{mutex};
+            timer_fd = fd;
+            timer_handle = runner.register_fd_handler(mir::Fd{fd}, [this](int fd)
+                {
+                    std::uint64_t expirations;
+                    while (read(fd, &expirations, sizeof expirations) > 0)
+                        ;
+                    check_pressure();
+                });
+            update_timer();
+        });
+
+    // Don't leave anything frozen when we go
+    runner.add_stop_callback([this] { thaw_all(); });
+}
+
+miriway::AppFreezer::~AppFreezer()
+{
+    thaw_all();
+}
+
+void miriway::AppFreezer::window_added(Window const& window)
+{
+    std::lock_guard lock{mutex};
+    processes[pid_of(window.application())].windows.emplace(window, false);
+}
+
+void miriway::AppFreezer::window_removed(Window const& window)
+{
+    std::lock_guard lock{mutex};
+    auto const pid = pid_of(window.application());
+    if (auto const i = processes.find(pid); i != processes.end())
+    {
+        auto& process = i->second;
+        if (auto const w = process.windows.find(window); w != process.windows.end())
+        {
+            if (w->second)
+            {
+                --process.hidden_windows;
+            }
+            process.windows.erase(w);
+        }
+
+        if (process.windows.empty())
+        {
+            thaw(pid, process);
+            processes.erase(i);
+        }
+        else if (process.all_hidden() && !process.frozen_cgroup && !process.stopped)
+        {
+            // Closing the last visible window leaves the rest hidden (closing a hidden one leaves any freeze)
+            process.all_hidden_since = Clock::now();
+        }
+    }
+}
+
+void miriway::AppFreezer::window_hidden(Window const& window)
+{
+    std::lock_guard lock{mutex};
+    if (auto const i = processes.find(pid_of(window.application())); i != processes.end())
+    {
+        auto& process = i->second;
+        if (auto const w = process.windows.find(window); w != process.windows.end() && !w->second)
+        {
+            w->second = true;
+            if (++process.hidden_windows == process.windows.size())
+            {
+                process.all_hidden_since = Clock::now();
+            }
+        }
+    }
+}
+
+void miriway::AppFreezer::window_shown(Window const& window)
+{
+    std::lock_guard lock{mutex};
+    auto const pid = pid_of(window.application());
+    if (auto const i = processes.find(pid); i != processes.end())
+    {
+        auto& process = i->second;
+        if (auto const w = process.windows.find(window); w != process.windows.end() && w->second)
+        {
+            w->second = false;
+            --process.hidden_windows;
+
+            // The app has a window showing again
+            thaw(pid, process);
+        }
+    }
+}
+
+void miriway::AppFreezer::window_focused(Window const& window)
+{
+    std::lock_guard lock{mutex};
+    auto const pid = pid_of(window.application());
+
+    // Wayland clients can only set the clipboard while they have focus
+    if (pid != focused)
+    {
+        previously_focused = focused;
+        focused = pid;
+    }
+}
+
+void miriway::AppFreezer::update_timer()
+{
+    if (timer_fd == -1)
+    {
+        return;
+    }
+
+    auto const enabled = hidden_for.count() > 0;
+    if (enabled && !memory_pressure())
+    {
+        mir::log_warning("Memory pressure is not available (/proc/pressure/memory), hidden apps will not be frozen");
+    }
+
+    auto const interval = timespec{enabled ? check_interval.count() : 0, 0};
+    auto const spec = itimerspec{interval, interval};
+    timerfd_settime(timer_fd, 0, &spec, nullptr);
+}
+
+void miriway::AppFreezer::check_pressure()
+{
+    auto const pressure = memory_pressure();
+
+    std::lock_guard lock{mutex};
+    if (!pressure || *pressure < pressure_threshold || hidden_for.count() == 0)
+    {
+        return;
+    }
+
+    auto const hidden_before = Clock::now() - hidden_for;
+    for (auto& [pid, process] : processes)
+    {
+        // Don't freeze an app that may be asked to serve a paste (the receiver would hang)
+        if (pid == focused || pid == previously_focused)
+            continue;
+
+        if (!process.frozen_cgroup && !process.stopped &&
+            process.all_hidden() && process.all_hidden_since <= hidden_before)
+        {
+            freeze(pid, process, *pressure);
+        }
+    }
+}
+
+void miriway::AppFreezer::freeze(pid_t pid, Process& process, double pressure)
+{
+    // Never freeze ourselves, or Xwayland (which serves every X11 app)
+    if (pid <= 0 || pid == getpid() || command_of(pid) == "Xwayland")
+    {
+        return;
+    }
+
+    // An app with a cgroup to itself (e.g. "app-firefox-1234.scope") can be frozen along with
+    // any helper processes, provided none of the processes in it has a window showing.
+    // Otherwise only the process itself can be stopped.
+    auto const& cgroup = cgroup_for(pid, process);
+    if (!cgroup.empty() && cgroup != own_cgroup && cgroup.filename().string().starts_with("app-") &&
+        std::ranges::all_of(processes, [&](auto& other)
+            {
+                return cgroup_for(other.first, other.second) != cgroup || other.second.all_hidden();
+            }))
+    {
+        auto const freeze_file = std::filesystem::path{"/sys/fs/cgroup"} / cgroup.relative_path() / "cgroup.freeze";
+        if (write_to(freeze_file, "1"))
+        {
+            // The other processes in the cgroup are frozen too (and are thawed with it)
+            for (auto& [_, other] : processes)
+            {
+                if (other.cgroup == cgroup)
+                    other.frozen_cgroup = freeze_file;
+            }
+        }
+    }
+
+    if (!process.frozen_cgroup)
+    {
+        if (kill(pid, SIGSTOP) != 0)
+        {
+            return;
+        }
+        process.stopped = true;
+    }
+
+    mir::log_info("Froze pid %d (%s) under memory pressure %.1f%%",
+        pid, process.frozen_cgroup ? "cgroup freezer" : "SIGSTOP", pressure);
+}
+
+auto miriway::AppFreezer::cgroup_for(pid_t pid, Process& process) -> std::filesystem::path const&
+{
+    if (!process.cgroup)
+    {
+        process.cgroup = cgroup_of(std::to_string(pid));
+    }
+
+    return *process.cgroup;
+}
+
+void miriway::AppFreezer::thaw(pid_t pid, Process& process)
+{
+    if (process.frozen_cgroup)
+    {
+        auto const freeze_file = *process.frozen_cgroup;
+        write_to(freeze_file, "0");
+        for (auto& [_, other] : processes)
+        {
+            if (other.frozen_cgroup == freeze_file)
+                other.frozen_cgroup.reset();
+        }
+        mir::log_info("Thawed pid %d", pid);
+    }
+    else if (process.stopped)
+    {
+        kill(pid, SIGCONT);
+        process.stopped = false;
+        mir::log_info("Thawed pid %d", pid);
+    }
+}
+
+void miriway::AppFreezer::thaw_all()
+{
+    std::lock_guard lock{mutex};
+    for (auto& [pid, process] : processes)
+    {
+        thaw(pid, process);
+    }
+}
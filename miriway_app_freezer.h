@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_APP_FREEZER_H
+#define MIRIWAY_APP_FREEZER_H
+
+#include <miral/live_config.h>
+#include <miral/runner.h>
+#include <miral/window.h>
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace miriway
+{
+using namespace miral;
+
+// Under memory pressure (as reported by /proc/pressure/memory) freezes applications whose
+// windows have all been on hidden workspaces for a while, so the OOM killer doesn't pick the
+// app in use while idle ones keep running. A frozen application is thawed as soon as any of
+// its windows is shown.
+//
+// Applications in their own cgroup (as launched by a systemd session) are frozen with the
+// cgroup v2 freezer, others are stopped with SIGSTOP. This is disabled by default: a frozen
+// client doesn't read its Wayland connection, and if that backs up the client is disconnected.
+// Nor can it serve a paste, so the app that last lost focus (the likely clipboard owner) is
+// never frozen.
+class AppFreezer
+{
+public:
+    AppFreezer(MirRunner& runner, live_config::Store& store);
+    ~AppFreezer();
+
+    // Called as windows are created and deleted
+    void window_added(Window const& window);
+    void window_removed(Window const& window);
+
+    // Called as windows are hidden (on a hidden workspace) and shown again
+    void window_hidden(Window const& window);
+    void window_shown(Window const& window);
+
+    // Called as a window gains focus
+    void window_focused(Window const& window);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Process
+    {
+        std::map<Window, bool> windows;     // Whether each window is hidden
+        std::size_t hidden_windows = 0;
+        Clock::time_point all_hidden_since;
+
+        // The process's cgroup (read when first needed)
+        std::optional<std::filesystem::path> cgroup;
+
+        // How the process is frozen (if it is)
+        std::optional<std::filesystem::path> frozen_cgroup;
+        bool stopped = false;
+
+        // Only an app with every one of its windows (including dialogs and the like) hidden may be frozen
+        auto all_hidden() const -> bool { return !windows.empty() && hidden_windows == windows.size(); }
+    };
+
+    std::mutex mutex;
+    std::chrono::seconds hidden_for;    // Zero disables freezing
+    int pressure_threshold;
+    std::unordered_map<pid_t, Process> processes;
+
+    // The app with focus, and the one before it (which most likely owns the clipboard)
+    pid_t focused = 0;
+    pid_t previously_focused = 0;
+
+    std::filesystem::path const own_cgroup;
+    std::unique_ptr<FdHandle> timer_handle;
+    int timer_fd = -1;
+
+    void update_timer();
+    void check_pressure();
+    void freeze(pid_t pid, Process& process, double pressure);
+    auto cgroup_for(pid_t pid, Process& process) -> std::filesystem::path const&;
+    void thaw(pid_t pid, Process& process);
+    void thaw_all();
+};
+}
+
+#endif //MIRIWAY_APP_FREEZER_H
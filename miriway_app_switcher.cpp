@@ -17,11 +17,11 @@
  */
 
 #include "miriway_app_switcher.h"
+#include "miriway_commands.h"
+#include "miriway_input_event.h"
 
 #include <mir_toolkit/events/enums.h>
-#include <miral/application_switcher.h>
 #include <miral/toolkit_event.h>
-#include <miral/internal_client.h>
 
 #include <linux/input-event-codes.h>
 
@@ -51,56 +51,45 @@ public:
         MirInputEventModifier reverse_modifier = mir_input_event_modifier_shift;
 
         /// This is the key that must be clicked in order to trigger either
-        /// #ApplicationSwitcher::next_app or #ApplicationSwitcher::prev_app,
+        /// switching to the next or previous application,
         /// depending on the modifiers that are currently being held.
         ///
         /// Defaults to KEY_TAB.
         int application_key = KEY_TAB;
 
         /// This is the key that must be clicked in order to trigger either
-        /// #ApplicationSwitcher::next_window or #ApplicationSwitcher::prev_window,
+        /// switching to the next or previous window of the application,
         /// depending on the modifiers that are currently being held.
         ///
         /// Defaults to KEY_GRAVE.
         int window_key = KEY_GRAVE;
 
         /// This is the key that must be clicked in order cancel the
-        ///#ApplicationSwitcher
+        /// switch
         ///
         /// Defaults to KEY_ESC.
         int escape_key = KEY_ESC;
     };
 
-    explicit Self(KeybindConfiguration const& keybind_configuration)
+    Self(KeybindConfiguration const& keybind_configuration, ShellCommands& commands)
         : keybind_configuration{keybind_configuration},
-        startup_internal_client{switcher, switcher, [switcher=switcher] { switcher.stop(); }}
+        commands{commands}
     {
     }
 
-    void operator()(mir::Server& server)
+    bool process_event(InputEvent const& event)
     {
-        startup_internal_client(server);
-    }
-
-    bool process_event(MirEvent const* event)
-    {
-        if (mir_event_get_type(event) != mir_event_type_input)
+        if (event.type != InputEvent::Type::key)
             return false;
 
-        auto const* input_event = mir_event_get_input_event(event);
-
-        if (mir_input_event_get_type(input_event) != mir_input_event_type_key)
-            return false;
+        auto const modifiers = event.modifiers;
 
-        auto const key_event = mir_input_event_get_keyboard_event(input_event);
-        auto const modifiers = mir_keyboard_event_modifiers(key_event);
-
-        if (mir_keyboard_event_action(key_event) == mir_keyboard_action_down)
+        if (event.key_action == mir_keyboard_action_down)
         {
-            auto const scancode = mir_keyboard_event_scan_code(key_event);
+            auto const scancode = event.scan_code;
             if (is_running && scancode == keybind_configuration.escape_key)
             {
-                switcher.cancel();
+                commands.switch_cancel();
                 is_running = false;
                 return true;
             }
@@ -110,13 +99,13 @@ public:
                 {
                     if (scancode == keybind_configuration.application_key)
                     {
-                        switcher.prev_app();
+                        commands.switch_app(true);
                         is_running = true;
                         return true;
                     }
                     else if (scancode == keybind_configuration.window_key)
                     {
-                        switcher.prev_window();
+                        commands.switch_window(true);
                         is_running = true;
                         return true;
                     }
@@ -125,24 +114,24 @@ public:
                 {
                     if (scancode == keybind_configuration.application_key)
                     {
-                        switcher.next_app();
+                        commands.switch_app(false);
                         is_running = true;
                         return true;
                     }
                     else if (scancode == keybind_configuration.window_key)
                     {
-                        switcher.next_window();
+                        commands.switch_window(false);
                         is_running = true;
                         return true;
                     }
                 }
             }
         }
-        else if (is_running && miral::toolkit::mir_keyboard_event_action(key_event) == mir_keyboard_action_up)
+        else if (is_running && event.key_action == mir_keyboard_action_up)
         {
             if (!(modifiers & keybind_configuration.primary_modifier))
             {
-                switcher.confirm();
+                commands.switch_confirm();
                 is_running = false;
                 return true;
             }
@@ -152,29 +141,23 @@ public:
      }
 
     const KeybindConfiguration keybind_configuration;
-    miral::ApplicationSwitcher switcher;
-    miral::StartupInternalClient startup_internal_client;
+    ShellCommands& commands;
 
     std::atomic<bool> is_running = false;
 };
 
-miriway::AppSwitcher::AppSwitcher() :
+miriway::AppSwitcher::AppSwitcher(ShellCommands& commands) :
     self{std::make_shared<Self>(Self::KeybindConfiguration{
         .primary_modifier = mir_input_event_modifier_alt,
         .reverse_modifier = mir_input_event_modifier_shift,
         .application_key = KEY_TAB,
         .window_key = KEY_GRAVE,
         .escape_key = KEY_ESC
-    })}
-{
-}
-
-void miriway::AppSwitcher::operator()(mir::Server& server)
+    }, commands)}
 {
-    self->operator()(server);
 }
 
-bool miriway::AppSwitcher::process_event(MirEvent const* event)
+bool miriway::AppSwitcher::process_event(InputEvent const& event)
 {
     return self->process_event(event);
 }
@@ -21,18 +21,19 @@
 
 #include <memory>
 
-struct MirEvent;
-namespace mir { class Server; }
-
 namespace miriway
 {
+struct InputEvent;
+class ShellCommands;
+
+// Alt+Tab (and Alt+`) switching between applications (and their windows). The switching is done
+// by the window manager, through the windows in most recently used order across all workspaces.
 class AppSwitcher
 {
 public:
-    AppSwitcher();
+    explicit AppSwitcher(ShellCommands& commands);
 
-    void operator()(mir::Server& server);
-    bool process_event(MirEvent const* event);
+    bool process_event(InputEvent const& event);
 
 private:
     class Self;
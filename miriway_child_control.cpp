@@ -24,14 +24,21 @@
 
 #include <mir/log.h>
 
+#include <sys/inotify.h>
 #include <sys/wait.h>
 #include <sys/timerfd.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <ctime>
+#include <filesystem>
 #include <map>
 #include <mutex>
 #include <numeric>
+#include <optional>
+#include <sstream>
 
 class miriway::ChildControl::Self
 {
@@ -39,7 +46,8 @@ public:
 
     explicit Self(MirRunner& runner) :
         runner{runner},
-        shell_pids{runner}
+        shell_pids{runner},
+        executables{runner}
     {
         runner.add_stop_callback([this]{ shell_pids.shutdown(); });
     }
@@ -130,6 +138,169 @@ public:
         }
     };
 
+    // Cache the absolute path of the executables we launch, so that launching (e.g. from a
+    // shortcut) doesn't search PATH each time. The cache is refreshed when PATH directories change.
+    struct Executables
+    {
+        Executables(MirRunner& runner)
+        {
+            if (auto const path = getenv("PATH"))
+            {
+                std::istringstream dirs{path};
+                for (std::string dir; std::getline(dirs, dir, ':');)
+                {
+                    if (!dir.empty()) search_path.push_back(dir);
+                }
+            }
+
+            runner.add_start_callback([this, &runner]
+                {
+                    auto const inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+                    if (inotify_fd == -1)
+                    {
+                        mir::log_warning("inotify_init1 failed, executable lookup will not be cached");
+                        std::lock_guard lock{mutex};
+                        enabled = false;
+                        paths.clear();
+                        return;
+                    }
+
+                    unwatched = search_path;
+                    watch_search_path(inotify_fd);
+
+                    watch = runner.register_fd_handler(mir::Fd{inotify_fd}, [this](int fd)
+                        {
+                            char buffer[4096];
+                            while (read(fd, buffer, sizeof buffer) > 0)
+                                ;
+                            watch_search_path(fd);
+                            refresh();
+                        });
+                });
+        }
+
+        // If `cmd` names an executable without a path, use the cached absolute path (if any)
+        auto resolve(std::vector<std::string> const& cmd) -> std::vector<std::string>
+        {
+            if (cmd.empty() || cmd.front().find('/') != std::string::npos)
+                return cmd;
+
+            std::optional<std::string> path;
+            bool cached = false;
+            {
+                std::lock_guard lock{mutex};
+                if (!enabled)
+                    return cmd;
+
+                if (auto const i = paths.find(cmd.front()); i != paths.end())
+                {
+                    path = i->second;
+                    cached = true;
+                }
+            }
+
+            if (!cached)
+            {
+                // Search PATH without holding the lock (so other launches aren't held up)
+                path = lookup(cmd.front());
+                std::lock_guard lock{mutex};
+                paths.try_emplace(cmd.front(), path);
+            }
+
+            if (!path)
+                return cmd;
+
+            auto result = cmd;
+            result.front() = path.value();
+            return result;
+        }
+
+    private:
+        std::vector<std::filesystem::path> search_path;
+        std::unique_ptr<miral::FdHandle> watch;
+
+        // PATH directories that could not be watched yet (because they don't exist)
+        std::vector<std::filesystem::path> unwatched;
+
+        std::mutex mutex;
+        bool enabled = true;
+        std::map<std::string, std::optional<std::string>> paths;
+
+        auto lookup(std::string const& name) const -> std::optional<std::string>
+        {
+            for (auto const& dir : search_path)
+            {
+                auto const candidate = dir / name;
+                std::error_code ec;
+                if (std::filesystem::is_regular_file(candidate, ec) && access(candidate.c_str(), X_OK) == 0)
+                    return candidate.string();
+            }
+
+            return std::nullopt;
+        }
+
+        // Watch the PATH directories not yet watched. A directory that doesn't exist (yet) is
+        // waited for by watching the nearest ancestor that does for it being created.
+        void watch_search_path(int inotify_fd)
+        {
+            std::erase_if(unwatched, [inotify_fd](std::filesystem::path const& dir)
+                {
+                    if (inotify_add_watch(
+                        inotify_fd, dir.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB) != -1)
+                    {
+                        return true;
+                    }
+
+                    if (errno != ENOENT)
+                    {
+                        mir::log_warning("Cannot watch %s for executables (%s), launches from it may use a stale path",
+                            dir.c_str(), std::strerror(errno));
+                        return true;
+                    }
+
+                    for (auto ancestor = dir.parent_path(); !ancestor.empty(); ancestor = ancestor.parent_path())
+                    {
+                        if (inotify_add_watch(inotify_fd, ancestor.c_str(), IN_CREATE | IN_MOVED_TO | IN_MASK_ADD) != -1)
+                        {
+                            mir::log_debug("%s does not exist, watching %s for it", dir.c_str(), ancestor.c_str());
+                            return false;
+                        }
+
+                        if (errno != ENOENT || ancestor == ancestor.parent_path())
+                            break;
+                    }
+
+                    mir::log_warning("Cannot watch %s for executables (%s), launches from it may use a stale path",
+                        dir.c_str(), std::strerror(errno));
+                    return true;
+                });
+        }
+
+        // Re-resolve everything we've been asked about, so launches don't wait on the lookup.
+        // (The lookups are done without holding the lock, which launches take.)
+        void refresh()
+        {
+            std::vector<std::string> names;
+            {
+                std::lock_guard lock{mutex};
+                for (auto const& [name, _] : paths)
+                {
+                    names.push_back(name);
+                }
+            }
+
+            std::map<std::string, std::optional<std::string>> refreshed;
+            for (auto const& name : names)
+            {
+                refreshed.emplace(name, lookup(name));
+            }
+
+            std::lock_guard lock{mutex};
+            refreshed.merge(paths);
+            paths.swap(refreshed);
+        }
+    };
+
     MirRunner& runner;
 
     // To support docks, onscreen keyboards, launchers and the like; enable a number of protocol extensions,
@@ -137,6 +308,7 @@ public:
     // We'll use `shell_pids` to track "shell-*" processes.
     // We also check `user_preference()` so these can be enabled by the configuration
     ShellPids shell_pids;
+    Executables executables;
     ExternalClientLauncher client_launcher;
 
     std::function<bool(WaylandExtensions::EnableInfo const& info)> const enable_for_shell_pids =
@@ -204,7 +376,7 @@ public:
                     info->handle.reset();
                     info->runs_in_quick_succession++;
                     info->last_run_time = std::time(nullptr);
-                    shell_pids.insert(client_launcher.launch(cmd), [this, info, &cmd] {
+                    shell_pids.insert(client_launcher.launch(executables.resolve(cmd)), [this, info, &cmd] {
                         if (info->should_restart_predicate())
                             shell_launch(cmd, info);
                     });
@@ -215,7 +387,7 @@ public:
             {
                 info->runs_in_quick_succession = 0;
                 info->last_run_time = now;
-                shell_pids.insert(client_launcher.launch(cmd), [this, info, &cmd] {
+                shell_pids.insert(client_launcher.launch(executables.resolve(cmd)), [this, info, &cmd] {
                     if (info->should_restart_predicate())
                         shell_launch(cmd, info);
                 });
@@ -242,13 +414,20 @@ void miriway::ChildControl::launch_shell(std::vector<std::string> const& cmd, st
 {
     self->shell_launch(cmd, std::make_shared<Self::ShellComponentRunInfo>(should_restart_predicate));
 }
-void miriway::ChildControl::run_shell(std::vector<std::string> const& cmd)
+auto miriway::ChildControl::run_shell(std::vector<std::string> const& cmd) -> pid_t
+{
+    auto const pid = self->client_launcher.launch(self->executables.resolve(cmd));
+    self->shell_pids.insert(pid);
+    return pid;
+}
+auto miriway::ChildControl::run_app(std::vector<std::string> const& cmd) -> pid_t
 {
-    self->shell_pids.insert(self->client_launcher.launch(cmd));
+    return self->client_launcher.launch(self->executables.resolve(cmd));
 }
-void miriway::ChildControl::run_app(std::vector<std::string> const& cmd)
+
+void miriway::ChildControl::resolve_executable(std::vector<std::string> const& cmd)
 {
-    self->client_launcher.launch(cmd);
+    self->executables.resolve(cmd);
 }
 
 void miriway::ChildControl::enable_for_shell(WaylandExtensions& extensions, std::string const& protocol)
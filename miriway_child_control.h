@@ -19,6 +19,8 @@
 #ifndef MIRIWAY_CHILD_CONTROL_H
 #define MIRIWAY_CHILD_CONTROL_H
 
+#include <sys/types.h>
+
 #include <functional>
 #include <memory>
 #include <string>
@@ -40,8 +42,11 @@ public:
 
     void launch_shell(std::vector<std::string> const& cmd);
     void launch_shell(std::vector<std::string> const& cmd, std::function<bool()> const should_restart_predicate);
-    void run_shell(std::vector<std::string> const& cmd);
-    void run_app(std::vector<std::string> const& cmd);
+    auto run_shell(std::vector<std::string> const& cmd) -> pid_t;
+    auto run_app(std::vector<std::string> const& cmd) -> pid_t;
+
+    // Look up the executable for `cmd` in PATH now, so that launching it later needn't
+    void resolve_executable(std::vector<std::string> const& cmd);
     void enable_for_shell(WaylandExtensions& extensions, std::string const& protocol);
 
 private:
@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_command_queue.h"
+
+#include <miral/runner.h>
+
+#include <mir/log.h>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <optional>
+
+namespace
+{
+// Docking (without shift) sets the placement of the active window: only the last of a run matters
+auto is_dock(miriway::WmCommand const& command) -> bool
+{
+    using Op = miriway::WmCommand::Op;
+    return !command.shift && (command.op == Op::dock_left || command.op == Op::dock_right);
+}
+}
+
+miriway::CommandQueue::CommandQueue(miral::MirRunner& runner, Execute execute) :
+    execute{std::move(execute)},
+    notify{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)}
+{
+    for (std::size_t i = 0; i != capacity; ++i)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    runner.add_start_callback([this, &runner]
+        {
+            handler = runner.register_fd_handler(notify, [this](int) { drain(); });
+        });
+}
+
+miriway::CommandQueue::~CommandQueue() = default;
+
+auto miriway::CommandQueue::post(WmCommand const& command) -> bool
+{
+    auto pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        auto& slot = slots[pos % capacity];
+        auto const sequence = slot.sequence.load(std::memory_order_acquire);
+
+        if (sequence == pos)
+        {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot.command = command;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                break;
+            }
+        }
+        else if (sequence < pos)
+        {
+            mir::log_warning("Window management command queue is full: command dropped");
+            return false;
+        }
+        else
+        {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    std::uint64_t const one = 1;
+    if (write(notify, &one, sizeof one) != sizeof one)
+    {
+        // The counter only saturates if the main loop is not draining: the commands will still be found
+    }
+    return true;
+}
+
+auto miriway::CommandQueue::pop(WmCommand& command) -> bool
+{
+    auto& slot = slots[dequeue_pos % capacity];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos + 1)
+        return false;
+
+    command = slot.command;
+    slot.sequence.store(dequeue_pos + capacity, std::memory_order_release);
+    ++dequeue_pos;
+    return true;
+}
+
+void miriway::CommandQueue::drain()
+{
+    std::uint64_t count;
+    if (read(notify, &count, sizeof count) != sizeof count)
+    {
+        // Nothing signalled (or already drained): still check the queue below
+    }
+
+    std::optional<WmCommand> pending;
+    WmCommand command;
+    while (pop(command))
+    {
+        if (pending && !(is_dock(*pending) && is_dock(command)))
+        {
+            execute(*pending);
+        }
+        pending = command;
+    }
+
+    if (pending)
+    {
+        execute(*pending);
+    }
+}
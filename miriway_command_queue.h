@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_COMMAND_QUEUE_H
+#define MIRIWAY_COMMAND_QUEUE_H
+
+#include "miriway_latency.h"
+
+#include <mir/fd.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace miral { class MirRunner; class FdHandle; }
+
+namespace miriway
+{
+// A window management command posted by the input filter
+struct WmCommand
+{
+    enum class Op : std::uint8_t
+    {
+        dock_left,
+        dock_right,
+        toggle_maximized_restored,
+        toggle_always_on_top,
+        workspace_begin,
+        workspace_end,
+        workspace_up,
+        workspace_down,
+        workspace_goto,
+        send_to_workspace,
+        send_to_workspace_step,
+        switch_app,
+        switch_window,
+        switch_confirm,
+        switch_cancel,
+    };
+
+    Op op;
+    bool shift;                 // (Or, for switching, whether to go in reverse)
+    int steps;                  // The steps for the ..._step ops, or the (1-based) workspace for the others
+    latency::Context latency;
+};
+
+// A bounded, lock-free, multiple producer, single consumer queue of window management commands.
+//
+// `post()` never blocks, so the input filter can return without waiting for the window management
+// lock. The commands are executed in order on the server's main loop.
+class CommandQueue
+{
+public:
+    using Execute = std::function<void(WmCommand const& command)>;
+
+    CommandQueue(miral::MirRunner& runner, Execute execute);
+    ~CommandQueue();
+
+    // Returns false (and drops the command) if the queue is full
+    auto post(WmCommand const& command) -> bool;
+
+    // Execute the queued commands now, rather than when the main loop next runs. (Only call
+    // this on the main loop: it is the single consumer.)
+    void drain();
+
+private:
+    static std::size_t constexpr capacity = 64;
+
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence;
+        WmCommand command;
+    };
+
+    Execute const execute;
+    std::array<Slot, capacity> slots;
+    std::atomic<std::size_t> enqueue_pos{0};
+    std::size_t dequeue_pos{0};
+    mir::Fd const notify;
+    std::unique_ptr<miral::FdHandle> handler;
+
+    auto pop(WmCommand& command) -> bool;
+};
+}
+
+#endif //MIRIWAY_COMMAND_QUEUE_H
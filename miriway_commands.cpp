@@ -17,6 +17,8 @@
  */
 
 #include "miriway_commands.h"
+#include "miriway_input_event.h"
+#include "miriway_latency.h"
 #include "miriway_policy.h"
 
 #include <miral/runner.h>
@@ -26,17 +28,23 @@
 #include <utility>
 #include <mir/log.h>
 
-miriway::ShellCommands::ShellCommands(
-    MirRunner& runner, CommandFunctor meta_command, CommandFunctor ctrl_alt_command, CommandFunctor alt_command, CommandFunctor key_command) :
-    runner{runner}, meta_command{std::move(meta_command)}, ctrl_alt_command{std::move(ctrl_alt_command)}, alt_command{std::move(alt_command)}, key_command{std::move(key_command)}
+miriway::ShellCommands::ShellCommands(MirRunner& runner, CommandFunctor command, WindowFunctor new_window) :
+    runner{runner},
+    command{std::move(command)},
+    new_window{std::move(new_window)},
+    wm_commands{runner, [this](WmCommand const& command) { execute(command); }}
 {
 }
 
-void miriway::ShellCommands::advise_new_window_for(miral::Application const& /*app*/)
+void miriway::ShellCommands::advise_new_window_for(miral::Application const& app)
 {
-    std::lock_guard<decltype(mutex)> lock{mutex};
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+
+        ++app_windows;
+    }
 
-    ++app_windows;
+    new_window(app);
 }
 
 void miriway::ShellCommands::advise_delete_window_for(miral::Application const& /*app*/)
@@ -46,19 +54,21 @@ void miriway::ShellCommands::advise_delete_window_for(miral::Application const&
     --app_windows;
 }
 
-auto miriway::ShellCommands::keyboard_shortcuts(MirKeyboardEvent const* kev) -> bool
+auto miriway::ShellCommands::keyboard_shortcuts(InputEvent const& kev) -> bool
 {
-    if (mir_keyboard_event_action(kev) == mir_keyboard_action_up)
+    if (kev.key_action == mir_keyboard_action_up)
         return false;
 
-    auto const mods = mir_keyboard_event_modifiers(kev);
-    auto const key_code = mir_keyboard_event_keysym(kev);
+    latency::Probe const probe{kev.event_time};
+
+    auto const mods = kev.modifiers;
+    auto const key_code = kev.keysym;
 
     auto const ctrl_alt = mir_input_event_modifier_alt | mir_input_event_modifier_ctrl;
 
     if ((mods & ctrl_alt) == ctrl_alt)
     {
-        if (key_code == XKB_KEY_Delete && mir_keyboard_event_action(kev) == mir_keyboard_action_down)
+        if (key_code == XKB_KEY_Delete && kev.key_action == mir_keyboard_action_down)
         {
             shell_commands_active = !shell_commands_active;
             return true;
@@ -69,21 +79,21 @@ auto miriway::ShellCommands::keyboard_shortcuts(MirKeyboardEvent const* kev) ->
         return false;
 
 
-    if (mir_keyboard_event_action(kev) == mir_keyboard_action_down)
+    if (kev.key_action == mir_keyboard_action_down)
     {
         if ((mods & ctrl_alt) == ctrl_alt)
         {
-            return ctrl_alt_command(key_code, mods & mir_input_event_modifier_shift, this);
+            return command(Modifiers::ctrl_alt, key_code, mods & mir_input_event_modifier_shift, this);
         }
 
         if ((mods & mir_input_event_modifier_meta) == mir_input_event_modifier_meta)
         {
-            return meta_command(key_code, mods & mir_input_event_modifier_shift, this);
+            return command(Modifiers::meta, key_code, mods & mir_input_event_modifier_shift, this);
         }
 
         if ((mods & mir_input_event_modifier_alt) == mir_input_event_modifier_alt)
         {
-            return alt_command(key_code, mods & mir_input_event_modifier_shift, this);
+            return command(Modifiers::alt, key_code, mods & mir_input_event_modifier_shift, this);
         }
 
         auto const real_mods =
@@ -93,36 +103,169 @@ auto miriway::ShellCommands::keyboard_shortcuts(MirKeyboardEvent const* kev) ->
             mir_input_event_modifier_meta;
         if (!(mods & real_mods))
         {
-            return key_command(key_code, false, this);
+            return command(Modifiers::plain, key_code, false, this);
         }
     }
 
     return false;
 }
 
-auto miriway::ShellCommands::touch_shortcuts(MirTouchEvent const* /*tev*/) -> bool
+auto miriway::ShellCommands::touch_shortcuts(MirTouchEvent const* tev) -> bool
 {
-    return false;
+    if (!shell_commands_active)
+        return false;
+
+    auto const [consumed, gesture] = touch_gestures.process(tev);
+
+    switch (gesture)
+    {
+    case TouchGestures::Gesture::swipe_up:
+        workspace_down(false);
+        break;
+
+    case TouchGestures::Gesture::swipe_down:
+        workspace_up(false);
+        break;
+
+    case TouchGestures::Gesture::pinch_in:
+    case TouchGestures::Gesture::pinch_out:
+        toggle_maximized_restored(false);
+        break;
+
+    case TouchGestures::Gesture::none:;
+    }
+
+    return consumed;
+}
+
+namespace
+{
+auto const pointer_modifiers = mir_input_event_modifier_alt | mir_input_event_modifier_ctrl | mir_input_event_modifier_meta;
+
+// Pointer buttons and scrolling are bound using the corresponding (X11 heritage) keysyms
+auto keysym_for_button(MirPointerButtons button) -> xkb_keysym_t
+{
+    switch (button)
+    {
+    case mir_pointer_button_primary:    return XKB_KEY_Pointer_Button1;
+    case mir_pointer_button_tertiary:   return XKB_KEY_Pointer_Button2;
+    case mir_pointer_button_secondary:  return XKB_KEY_Pointer_Button3;
+    default:                            return XKB_KEY_NoSymbol;
+    }
 }
 
-auto miriway::ShellCommands::input_event(MirEvent const* event) -> bool
+auto keysym_for_scroll(float vscroll, float hscroll) -> xkb_keysym_t
 {
-    if (mir_event_get_type(event) != mir_event_type_input)
+    if (vscroll) return vscroll < 0 ? XKB_KEY_Pointer_Up : XKB_KEY_Pointer_Down;
+    if (hscroll) return hscroll < 0 ? XKB_KEY_Pointer_Left : XKB_KEY_Pointer_Right;
+    return XKB_KEY_NoSymbol;
+}
+}
+
+auto miriway::ShellCommands::pointer_shortcuts(InputEvent const& pev) -> bool
+{
+    // Pointer bindings all need a modifier: unmodified motion (by far the commonest event) stops here
+    if (pev.pointer_action == mir_pointer_action_motion && !(pev.modifiers & pointer_modifiers))
         return false;
 
-    auto const* input_event = mir_event_get_input_event(event);
+    xkb_keysym_t key_code = XKB_KEY_NoSymbol;
+    MirPointerButtons pressed = 0;
 
-    switch (mir_input_event_get_type(input_event))
+    switch (pev.pointer_action)
     {
-    case mir_input_event_type_touch:
-        return touch_shortcuts(mir_input_event_get_touch_event(input_event));
+    // (`pointer_buttons` is updated once the event is processed, see `input_processed()`)
+    case mir_pointer_action_button_down:
+        pressed = pev.pointer_buttons & ~pointer_buttons;
+        key_code = keysym_for_button(pressed);
+        break;
+
+    case mir_pointer_action_button_up:
+        return (consumed_buttons & pointer_buttons & ~pev.pointer_buttons) != 0;
 
-    case mir_input_event_type_key:
-        return keyboard_shortcuts(mir_input_event_get_keyboard_event(input_event));
+    case mir_pointer_action_motion:
+        key_code = keysym_for_scroll(pev.vscroll_discrete, pev.hscroll_discrete);
+        break;
 
     default:
         return false;
     }
+
+    if (key_code == XKB_KEY_NoSymbol || !shell_commands_active)
+        return false;
+
+    latency::Probe const probe{pev.event_time};
+
+    auto const mods = pev.modifiers;
+    auto const with_shift = (mods & mir_input_event_modifier_shift) != 0;
+    auto const ctrl_alt = mir_input_event_modifier_alt | mir_input_event_modifier_ctrl;
+
+    bool consumed = false;
+    if ((mods & ctrl_alt) == ctrl_alt)
+    {
+        consumed = command(Modifiers::ctrl_alt, key_code, with_shift, this);
+    }
+    else if (mods & mir_input_event_modifier_meta)
+    {
+        consumed = command(Modifiers::meta, key_code, with_shift, this);
+    }
+    else if (mods & mir_input_event_modifier_alt)
+    {
+        consumed = command(Modifiers::alt, key_code, with_shift, this);
+    }
+
+    if (consumed)
+        consumed_buttons |= pressed;
+
+    return consumed;
+}
+
+auto miriway::ShellCommands::input_event(InputEvent const& event) -> bool
+{
+    switch (event.type)
+    {
+    case InputEvent::Type::touch:
+        return touch_shortcuts(event.touch_event);
+
+    case InputEvent::Type::pointer:
+        return pointer_shortcuts(event);
+
+    case InputEvent::Type::key:
+        return keyboard_shortcuts(event);
+
+    default:
+        return false;
+    }
+}
+
+void miriway::ShellCommands::input_processed(InputEvent const& event, bool consumed)
+{
+    switch (event.type)
+    {
+    case InputEvent::Type::touch:
+        if (!consumed)
+        {
+            touch_gestures.delivered(event.touch_event);
+        }
+        break;
+
+    case InputEvent::Type::pointer:
+        // Track the buttons even when the shortcuts were bypassed (e.g. while locked),
+        // so the next press or release is compared with the real state
+        if (event.pointer_action == mir_pointer_action_button_down ||
+            event.pointer_action == mir_pointer_action_button_up)
+        {
+            pointer_buttons = event.pointer_buttons;
+            consumed_buttons &= pointer_buttons;
+        }
+        break;
+
+    default:;
+    }
+}
+
+void miriway::ShellCommands::execute_queued_commands()
+{
+    wm_commands.drain();
 }
 
 void miriway::ShellCommands::init_window_manager(WindowManagerPolicy* wm)
@@ -130,44 +273,156 @@ void miriway::ShellCommands::init_window_manager(WindowManagerPolicy* wm)
     this->wm = wm;
 }
 
+void miriway::ShellCommands::post(WmCommand::Op op, bool shift, int steps) const
+{
+    wm_commands.post(WmCommand{op, shift, steps, latency::Probe::context()});
+}
+
+void miriway::ShellCommands::execute(WmCommand const& command) const
+{
+    if (!wm)
+        return;
+
+    latency::Probe const probe{command.latency};
+
+    switch (command.op)
+    {
+    case WmCommand::Op::dock_left:
+        wm->dock_active_window_left(command.shift);
+        break;
+
+    case WmCommand::Op::dock_right:
+        wm->dock_active_window_right(command.shift);
+        break;
+
+    case WmCommand::Op::toggle_maximized_restored:
+        wm->toggle_maximized_restored();
+        break;
+
+    case WmCommand::Op::toggle_always_on_top:
+        wm->toggle_always_on_top();
+        break;
+
+    case WmCommand::Op::workspace_begin:
+        wm->workspace_begin(command.shift);
+        break;
+
+    case WmCommand::Op::workspace_end:
+        wm->workspace_end(command.shift);
+        break;
+
+    case WmCommand::Op::workspace_up:
+        wm->workspace_up(command.shift);
+        break;
+
+    case WmCommand::Op::workspace_down:
+        wm->workspace_down(command.shift);
+        break;
+
+
+    case WmCommand::Op::workspace_goto:
+        wm->workspace_goto(command.steps, command.shift);
+        break;
+
+    case WmCommand::Op::send_to_workspace:
+        wm->send_to_workspace(command.steps);
+        break;
+
+    case WmCommand::Op::send_to_workspace_step:
+        wm->send_to_workspace_step(command.steps);
+        break;
+
+    case WmCommand::Op::switch_app:
+        wm->switch_app(command.shift);
+        break;
+
+    case WmCommand::Op::switch_window:
+        wm->switch_window(command.shift);
+        break;
+
+    case WmCommand::Op::switch_confirm:
+        wm->switch_confirm();
+        break;
+
+    case WmCommand::Op::switch_cancel:
+        wm->switch_cancel();
+        break;
+    }
+}
+
 void miriway::ShellCommands::dock_active_window_left(bool shift) const
 {
-    wm->dock_active_window_left(shift);
+    post(WmCommand::Op::dock_left, shift);
 }
 
 void miriway::ShellCommands::dock_active_window_right(bool shift) const
 {
-    wm->dock_active_window_right(shift);
+    post(WmCommand::Op::dock_right, shift);
 }
 
-void miriway::ShellCommands::toggle_maximized_restored(bool) const
+void miriway::ShellCommands::toggle_maximized_restored(bool shift) const
 {
-    wm->toggle_maximized_restored();
+    post(WmCommand::Op::toggle_maximized_restored, shift);
 }
 
-void miriway::ShellCommands::toggle_always_on_top(bool) const
+void miriway::ShellCommands::toggle_always_on_top(bool shift) const
 {
-    wm->toggle_always_on_top();
+    post(WmCommand::Op::toggle_always_on_top, shift);
 }
 
 void miriway::ShellCommands::workspace_begin(bool shift) const
 {
-    wm->workspace_begin(shift);
+    post(WmCommand::Op::workspace_begin, shift);
 }
 
 void miriway::ShellCommands::workspace_end(bool shift) const
 {
-    wm->workspace_end(shift);
+    post(WmCommand::Op::workspace_end, shift);
 }
 
 void miriway::ShellCommands::workspace_up(bool shift) const
 {
-    wm->workspace_up(shift);
+    post(WmCommand::Op::workspace_up, shift);
 }
 
 void miriway::ShellCommands::workspace_down(bool shift) const
 {
-    wm->workspace_down(shift);
+    post(WmCommand::Op::workspace_down, shift);
+}
+
+void miriway::ShellCommands::workspace_goto(int number, bool shift) const
+{
+    post(WmCommand::Op::workspace_goto, shift, number);
+}
+
+void miriway::ShellCommands::send_to_workspace(int number) const
+{
+    post(WmCommand::Op::send_to_workspace, false, number);
+}
+
+void miriway::ShellCommands::send_to_workspace_step(int steps) const
+{
+    post(WmCommand::Op::send_to_workspace_step, false, steps);
+}
+
+void miriway::ShellCommands::switch_app(bool reverse) const
+{
+    post(WmCommand::Op::switch_app, reverse);
+}
+
+void miriway::ShellCommands::switch_window(bool reverse) const
+{
+    post(WmCommand::Op::switch_window, reverse);
+}
+
+void miriway::ShellCommands::switch_confirm() const
+{
+    post(WmCommand::Op::switch_confirm, false);
+}
+
+void miriway::ShellCommands::switch_cancel() const
+{
+    post(WmCommand::Op::switch_cancel, false);
 }
 
 void miriway::ShellCommands::exit(bool shift) const
@@ -19,6 +19,9 @@
 #ifndef MIRIWAY_COMMANDS_H
 #define MIRIWAY_COMMANDS_H
 
+#include "miriway_command_queue.h"
+#include "miriway_touch_gestures.h"
+
 #include <miral/application.h>
 #include <miral/toolkit_event.h>
 
@@ -35,22 +38,37 @@ namespace miriway
 using namespace miral;
 
 class WindowManagerPolicy;
+struct InputEvent;
 
 // Process `input_event()` to identify commands Miriway needs to handle.
-// Commands will be routed to MirRunner, the WindowManagerPolicy, or a CommandFunctor as appropriate
+// Commands will be routed to MirRunner, the WindowManagerPolicy, or a CommandFunctor as appropriate.
+// Commands for the WindowManagerPolicy are queued, so that input processing never waits for the
+// window management lock.
 class ShellCommands
 {
 public:
-    using CommandFunctor = std::function<bool(xkb_keysym_t key_code, bool with_shift, ShellCommands* cmd)>;
+    // The modifier combinations that select a set of shortcuts
+    enum class Modifiers { meta, ctrl_alt, alt, plain };
+
+    using CommandFunctor = std::function<bool(Modifiers modifiers, xkb_keysym_t key_code, bool with_shift, ShellCommands* cmd)>;
+    using WindowFunctor = std::function<void(Application const& app)>;
 
-    ShellCommands(MirRunner& runner, CommandFunctor meta_command, CommandFunctor ctrl_alt_command, CommandFunctor alt_command, CommandFunctor key_command);
+    // `new_window` is notified when an application maps a window
+    ShellCommands(MirRunner& runner, CommandFunctor command, WindowFunctor new_window);
 
     void init_window_manager(WindowManagerPolicy* wm);
 
     void advise_new_window_for(Application const& app);
     void advise_delete_window_for(Application const& app);
 
-    auto input_event(MirEvent const* event) -> bool;
+    auto input_event(InputEvent const& event) -> bool;
+
+    // Every input event is reported here once routed (even those that bypassed `input_event()`,
+    // e.g. while locked) so what clients have been sent can be tracked
+    void input_processed(InputEvent const& event, bool consumed);
+
+    // Execute the queued window management commands now (on the main loop)
+    void execute_queued_commands();
     [[nodiscard]] auto shell_keyboard_enabled() const -> bool
         { return shell_commands_active; }
 
@@ -64,22 +82,40 @@ public:
     void workspace_end(bool shift) const;
     void workspace_up(bool shift) const;
     void workspace_down(bool shift) const;
+    void workspace_goto(int number, bool shift) const;
+    void send_to_workspace(int number) const;
+    void send_to_workspace_step(int steps) const;
+
+    // Switch between application windows in most recently used order (see `AppSwitcher`)
+    void switch_app(bool reverse) const;
+    void switch_window(bool reverse) const;
+    void switch_confirm() const;
+    void switch_cancel() const;
     void exit(bool shift) const;
 
 private:
-    auto keyboard_shortcuts(MirKeyboardEvent const* kev) -> bool;
+    auto keyboard_shortcuts(InputEvent const& kev) -> bool;
     auto touch_shortcuts(MirTouchEvent const* tev) -> bool;
+    auto pointer_shortcuts(InputEvent const& pev) -> bool;
 
     MirRunner& runner;
-    CommandFunctor meta_command;
-    CommandFunctor ctrl_alt_command;
-    CommandFunctor alt_command;
-    CommandFunctor key_command;
+    CommandFunctor command;
+    WindowFunctor const new_window;
     WindowManagerPolicy* wm = nullptr;
     std::atomic<bool> shell_commands_active = true;
+    TouchGestures touch_gestures;
+
+    // Pointer buttons currently pressed, and those whose press triggered a command
+    // (so the release must not reach clients either)
+    MirPointerButtons pointer_buttons = 0;
+    MirPointerButtons consumed_buttons = 0;
+    CommandQueue mutable wm_commands;
 
     std::mutex mutable mutex;
     int app_windows = 0;
+
+    void post(WmCommand::Op op, bool shift, int steps = 0) const;
+    void execute(WmCommand const& command) const;
 };
 }
 
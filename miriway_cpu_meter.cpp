@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_cpu_meter.h"
+
+#include <mir/log.h>
+
+#include <unistd.h>
+
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+namespace
+{
+// The user + system CPU time used by `pid` (from /proc/<pid>/stat)
+auto cpu_time_of(pid_t pid) -> std::optional<std::chrono::nanoseconds>
+{
+    std::ifstream stat{"/proc/" + std::to_string(pid) + "/stat"};
+    std::string line;
+    if (!std::getline(stat, line))
+        return std::nullopt;
+
+    // The command name (in parentheses) may contain spaces: the fields we want follow it
+    auto const fields_from = line.rfind(')');
+    if (fields_from == std::string::npos)
+        return std::nullopt;
+
+    std::istringstream fields{line.substr(fields_from + 1)};
+    std::string skip;
+    for (auto i = 3; i != 14; ++i)
+    {
+        fields >> skip;
+    }
+
+    unsigned long long utime = 0, stime = 0;
+    if (!(fields >> utime >> stime))
+        return std::nullopt;
+
+    static auto const ticks_per_second = sysconf(_SC_CLK_TCK);
+    return std::chrono::nanoseconds{std::chrono::seconds{utime + stime}} / ticks_per_second;
+}
+
+auto load(std::chrono::nanoseconds cpu, std::chrono::steady_clock::duration elapsed) -> double
+{
+    return elapsed.count() > 0 ? 100.0 * cpu / elapsed : 0.0;
+}
+}
+
+void miriway::CpuMeter::hidden(pid_t pid)
+{
+    auto const cpu = cpu_time_of(pid);
+    if (!cpu)
+        return;
+
+    auto const now = Clock::now();
+    auto& process = processes[pid];
+
+    if (process.hidden_windows++ == 0)
+    {
+        // Note the load over the visible period just ending (unknown the first time we see the process)
+        if (process.since != Clock::time_point{})
+        {
+            process.visible_load = load(*cpu - process.cpu_since, now - process.since);
+        }
+        process.since = now;
+        process.cpu_since = *cpu;
+    }
+}
+
+void miriway::CpuMeter::shown(pid_t pid)
+{
+    auto const i = processes.find(pid);
+    if (i == processes.end() || i->second.hidden_windows == 0)
+        return;
+
+    auto& process = i->second;
+    if (--process.hidden_windows != 0)
+        return;
+
+    auto const cpu = cpu_time_of(pid);
+    if (!cpu)
+    {
+        // The process has gone
+        processes.erase(i);
+        return;
+    }
+
+    auto const now = Clock::now();
+    auto const hidden_for = now - process.since;
+    auto const hidden_load = load(*cpu - process.cpu_since, hidden_for);
+
+    if (process.visible_load < 0)
+    {
+        mir::log_info("CPU meter: pid %d used %.1f%% CPU while hidden for %.1fs",
+            pid, hidden_load, std::chrono::duration<double>(hidden_for).count());
+    }
+    else
+    {
+        mir::log_info("CPU meter: pid %d used %.1f%% CPU while visible, %.1f%% while hidden for %.1fs",
+            pid, process.visible_load, hidden_load, std::chrono::duration<double>(hidden_for).count());
+    }
+
+    process.since = now;
+    process.cpu_since = *cpu;
+}
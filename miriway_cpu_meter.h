@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_CPU_METER_H
+#define MIRIWAY_CPU_METER_H
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <unordered_map>
+
+namespace miriway
+{
+// Measures the CPU used by client processes while their windows are hidden (on a hidden
+// workspace) and while they were visible beforehand, and logs both when they are shown again.
+class CpuMeter
+{
+public:
+    // One of `pid`'s windows has been hidden
+    void hidden(pid_t pid);
+
+    // One of `pid`'s hidden windows has been shown (or closed)
+    void shown(pid_t pid);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Process
+    {
+        int hidden_windows = 0;
+        Clock::time_point since;            // When the current (visible or hidden) period began
+        std::chrono::nanoseconds cpu_since; // The CPU time used by then
+        double visible_load = -1;           // The CPU load over the last visible period (if known)
+    };
+
+    std::unordered_map<pid_t, Process> processes;
+};
+}
+
+#endif //MIRIWAY_CPU_METER_H
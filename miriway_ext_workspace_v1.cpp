@@ -30,6 +30,7 @@
 #include <list>
 #include <map>
 #include <mutex>
+#include <optional>
 
 using miral::Workspace;
 
@@ -48,6 +49,7 @@ public:
     void output_deleted(miral::WaylandTools* wltools, miral::Output const& output);
 
     void workspace_created(std::weak_ptr<Workspace> const& wksp);
+    void workspace_assigned(std::weak_ptr<Workspace> const& wksp, int output_id, unsigned position);
     void workspace_activated(std::weak_ptr<Workspace> const& wksp);
     void workspace_deactivated(std::weak_ptr<Workspace> const& wksp);
     void workspace_destroyed(std::weak_ptr<Workspace> const& wksp);
@@ -60,8 +62,21 @@ public:
 private:
     void update_workspace_info(ExtWorkspaceHandleV1 const* wh, unsigned int i) const;
 
-    ExtWorkspaceGroupHandleV1* const the_workspace_group;
-    std::list<std::pair<std::weak_ptr<Workspace>, ExtWorkspaceHandleV1*>> workspaces;
+    // Number the workspaces not (yet) assigned to an output in creation order. (Assigned
+    // workspaces are numbered by their position on the output, as for "@workspace-N".)
+    void renumber_unassigned() const;
+
+    struct WorkspaceEntry
+    {
+        std::weak_ptr<Workspace> workspace;
+        ExtWorkspaceHandleV1* handle;
+        std::optional<int> output_id;   // The output (and group) the workspace is assigned to
+        unsigned position;              // The position among the output's workspaces
+    };
+
+    // A workspace group for each output
+    std::map<int, ExtWorkspaceGroupHandleV1*> groups;
+    std::list<WorkspaceEntry> workspaces;
 };
 
 class ExtWorkspaceManagerV1::Global : public mir::wayland::ExtWorkspaceManagerV1::Global
@@ -74,6 +89,7 @@ public:
     void output_added(miral::Output const& output);
     void output_removed(const miral::Output &output);
     void workspace_created(std::shared_ptr<Workspace> const& wksp);
+    void workspace_assigned(std::shared_ptr<Workspace> const& wksp, int output_id, unsigned position);
     void workspace_activated(std::shared_ptr<Workspace> const& wksp);
     void workspace_deactivated(std::shared_ptr<Workspace> const& wksp);
     void workspace_destroyed(std::shared_ptr<Workspace> const& wksp);
@@ -122,7 +138,13 @@ std::set<miral::Output, decltype([](auto const& l, auto const& r){ return l.id()
 // The workspace list is maintained "server side" and accessed "frontend side"
 std::mutex all_the_workspaces_mutex;
 enum class WkspState { active, hidden };
-std::map<std::shared_ptr<Workspace>, WkspState> all_the_workspaces;
+struct WkspInfo
+{
+    WkspState state;
+    std::optional<int> output_id;
+    unsigned position;
+};
+std::map<std::shared_ptr<Workspace>, WkspInfo> all_the_workspaces;
 
 std::function<void(std::shared_ptr<Workspace> const& wksp)> activate = [](auto const&){};
 }
@@ -131,19 +153,38 @@ void miriway::ExtWorkspaceV1::on_workspace_create(std::shared_ptr<Workspace> con
 {
     {
         std::lock_guard lock(all_the_workspaces_mutex);
-        all_the_workspaces.emplace(wksp, WkspState::hidden);
+        all_the_workspaces.emplace(wksp, WkspInfo{WkspState::hidden, std::nullopt, 0});
     }
     std::lock_guard lock{all_the_globals_mutex};
     for (auto const& global : all_the_globals)
         global->workspace_created(wksp);
 }
 
+void miriway::ExtWorkspaceV1::on_workspace_assign(
+    std::shared_ptr<Workspace> const& wksp, Output const& output, unsigned position)
+{
+    std::unique_lock lock(all_the_workspaces_mutex);
+    if (auto const i = all_the_workspaces.find(wksp); i != all_the_workspaces.end())
+    {
+        if (i->second.output_id == output.id() && i->second.position == position)
+            return;
+
+        i->second.output_id = output.id();
+        i->second.position = position;
+        lock.unlock();
+
+        std::lock_guard lock_g{all_the_globals_mutex};
+        for (auto const &global: all_the_globals)
+            global->workspace_assigned(wksp, output.id(), position);
+    }
+}
+
 void miriway::ExtWorkspaceV1::on_workspace_activate(std::shared_ptr<Workspace> const& wksp)
 {
     std::unique_lock lock(all_the_workspaces_mutex);
     if (auto const i = all_the_workspaces.find(wksp); i != all_the_workspaces.end())
     {
-        i->second = WkspState::active;
+        i->second.state = WkspState::active;
         lock.unlock();
 
         std::lock_guard lock_g{all_the_globals_mutex};
@@ -157,7 +198,7 @@ void miriway::ExtWorkspaceV1::on_workspace_deactivate(std::shared_ptr<Workspace>
     std::unique_lock lock(all_the_workspaces_mutex);
     if (auto const i = all_the_workspaces.find(wksp); i != all_the_workspaces.end())
     {
-        i->second = WkspState::hidden;
+        i->second.state = WkspState::hidden;
         lock.unlock();
 
         std::lock_guard lock_g{all_the_globals_mutex};
@@ -206,11 +247,8 @@ void miriway::ExtWorkspaceV1::set_workspace_activator_callback(std::function<voi
 }
 
 miriway::ExtWorkspaceManagerV1::ExtWorkspaceManagerV1(wl_resource* new_ext_workspace_manager_v1) :
-    mir::wayland::ExtWorkspaceManagerV1{new_ext_workspace_manager_v1, Version<1>{}},
-    the_workspace_group{new ExtWorkspaceGroupHandleV1{*this}}
+    mir::wayland::ExtWorkspaceManagerV1{new_ext_workspace_manager_v1, Version<1>{}}
 {
-    send_workspace_group_event(the_workspace_group->resource);
-    the_workspace_group->send_capabilities_event(0);
 }
 
 void miriway::ExtWorkspaceManagerV1::commit()
@@ -223,10 +261,24 @@ void miriway::ExtWorkspaceManagerV1::stop()
 
 void miriway::ExtWorkspaceManagerV1::output_added(miral::WaylandTools* wltools, miral::Output const& output)
 {
-    wltools->for_each_binding(client, output, [this](wl_resource* the_output)
+    if (groups.contains(output.id()))
+        return;
+
+    auto const group = new ExtWorkspaceGroupHandleV1{*this};
+    groups[output.id()] = group;
+    send_workspace_group_event(group->resource);
+    group->send_capabilities_event(0);
+
+    wltools->for_each_binding(client, output, [group](wl_resource* the_output)
     {
-        the_workspace_group->send_output_enter_event(the_output);
+        group->send_output_enter_event(the_output);
     });
+
+    for (auto const& entry : workspaces)
+    {
+        if (entry.output_id == output.id())
+            group->send_workspace_enter_event(entry.handle->resource);
+    }
 }
 
 void miriway::ExtWorkspaceManagerV1::Global::output_removed(const miral::Output &output)
@@ -246,22 +298,84 @@ void miriway::ExtWorkspaceManagerV1::Global::output_removed(const miral::Output
 
 void miriway::ExtWorkspaceManagerV1::output_deleted(miral::WaylandTools* wltools, miral::Output const& output)
 {
-    wltools->for_each_binding(client, output, [this](wl_resource* the_output)
+    auto const i = groups.find(output.id());
+    if (i == groups.end())
+        return;
+
+    auto const group = i->second;
+    groups.erase(i);
+
+    wltools->for_each_binding(client, output, [group](wl_resource* the_output)
     {
-        the_workspace_group->send_output_leave_event(the_output);
+        group->send_output_leave_event(the_output);
     });
+
+    // Any workspaces remaining are about to be assigned elsewhere
+    for (auto& entry : workspaces)
+    {
+        if (entry.output_id == output.id())
+        {
+            group->send_workspace_leave_event(entry.handle->resource);
+            entry.output_id.reset();
+        }
+    }
+
+    group->send_removed_event();
 }
 
 void miriway::ExtWorkspaceManagerV1::workspace_created(std::weak_ptr<Workspace> const& wksp)
 {
     auto const wh = new ExtWorkspaceHandleV1{*this};
-    workspaces.emplace_back(wksp, wh);
+    workspaces.push_back({wksp, wh, std::nullopt, 0});
     send_workspace_event(wh->resource);
     wh->send_capabilities_event(ExtWorkspaceHandleV1::WorkspaceCapabilities::activate);
 
-    update_workspace_info(wh, workspaces.size());
+    renumber_unassigned();
+}
+
+void miriway::ExtWorkspaceManagerV1::workspace_assigned(
+    std::weak_ptr<Workspace> const& wksp, int output_id, unsigned position)
+{
+    for (auto& entry : workspaces)
+    {
+        if (!entry.workspace.owner_before(wksp) && !wksp.owner_before(entry.workspace))
+        {
+            auto const old_output_id = entry.output_id;
+            if (old_output_id != output_id)
+            {
+                if (old_output_id)
+                {
+                    if (auto const group = groups.find(*old_output_id); group != groups.end())
+                        group->second->send_workspace_leave_event(entry.handle->resource);
+                }
+
+                entry.output_id = output_id;
+                if (auto const group = groups.find(output_id); group != groups.end())
+                    group->second->send_workspace_enter_event(entry.handle->resource);
+            }
+            else if (entry.position == position)
+            {
+                return;
+            }
 
-    the_workspace_group->send_workspace_enter_event(wh->resource);
+            entry.position = position;
+            update_workspace_info(entry.handle, position + 1);
+
+            if (!old_output_id)
+                renumber_unassigned();
+            return;
+        }
+    }
+}
+
+void miriway::ExtWorkspaceManagerV1::renumber_unassigned() const
+{
+    unsigned int i = 0;
+    for (auto const& entry : workspaces)
+    {
+        if (!entry.output_id)
+            update_workspace_info(entry.handle, ++i);
+    }
 }
 
 void miriway::ExtWorkspaceManagerV1::update_workspace_info(ExtWorkspaceHandleV1 const* wh, unsigned int i) const
@@ -278,11 +392,11 @@ void miriway::ExtWorkspaceManagerV1::update_workspace_info(ExtWorkspaceHandleV1
 
 void miriway::ExtWorkspaceManagerV1::workspace_activated(std::weak_ptr<Workspace> const& wksp)
 {
-    for (auto const& [_, wh]: workspaces)
+    for (auto const& entry : workspaces)
     {
-        if (!_.owner_before(wksp) && !wksp.owner_before(_))
+        if (!entry.workspace.owner_before(wksp) && !wksp.owner_before(entry.workspace))
         {
-            wh->send_state_event(ExtWorkspaceHandleV1::State::active);
+            entry.handle->send_state_event(ExtWorkspaceHandleV1::State::active);
             break;
         }
     }
@@ -290,11 +404,11 @@ void miriway::ExtWorkspaceManagerV1::workspace_activated(std::weak_ptr<Workspace
 
 void miriway::ExtWorkspaceManagerV1::workspace_deactivated(std::weak_ptr<Workspace> const& wksp)
 {
-    for (auto const& [_, wh]: workspaces)
+    for (auto const& entry : workspaces)
     {
-        if (!_.owner_before(wksp) && !wksp.owner_before(_))
+        if (!entry.workspace.owner_before(wksp) && !wksp.owner_before(entry.workspace))
         {
-            wh->send_state_event(ExtWorkspaceHandleV1::State::hidden);
+            entry.handle->send_state_event(ExtWorkspaceHandleV1::State::hidden);
             break;
         }
     }
@@ -302,41 +416,39 @@ void miriway::ExtWorkspaceManagerV1::workspace_deactivated(std::weak_ptr<Workspa
 
 void miriway::ExtWorkspaceManagerV1::workspace_destroyed(std::weak_ptr<Workspace> const& wksp)
 {
-    auto searching = true;
-    unsigned int i = 0;
-    for (auto it = workspaces.begin(); it != workspaces.end();)
+    for (auto it = workspaces.begin(); it != workspaces.end(); ++it)
     {
-        if (!it->first.owner_before(wksp) && !wksp.owner_before(it->first))
+        if (!it->workspace.owner_before(wksp) && !wksp.owner_before(it->workspace))
         {
-            the_workspace_group->send_workspace_leave_event(it->second->resource);
-            it->second->send_removed_event();
-            it = workspaces.erase(it);
-            searching = false;
-        }
-        else
-        {
-            ++i;
-            if (!searching)
+            auto const output_id = it->output_id;
+            if (output_id)
             {
-                update_workspace_info(it->second, i);
+                if (auto const group = groups.find(*output_id); group != groups.end())
+                    group->second->send_workspace_leave_event(it->handle->resource);
             }
-            ++it;
+            it->handle->send_removed_event();
+            workspaces.erase(it);
+
+            // (The workspaces remaining on an output are renumbered as they are reassigned)
+            if (!output_id)
+                renumber_unassigned();
+            return;
         }
     }
 }
 
 void miriway::ExtWorkspaceManagerV1::on_destroy(miriway::ExtWorkspaceHandleV1* wh)
 {
-    auto p = std::find_if(workspaces.begin(), workspaces.end(), [wh](auto const& wksp_pair) { return wksp_pair.second == wh; });
+    auto p = std::find_if(workspaces.begin(), workspaces.end(), [wh](auto const& e) { return e.handle == wh; });
     if (p != workspaces.end()) workspaces.erase(p);
 }
 
 void miriway::ExtWorkspaceManagerV1::on_activate(miriway::ExtWorkspaceHandleV1* wh)
 {
-    auto p = std::find_if(workspaces.begin(), workspaces.end(), [wh](auto const& e) { return e.second == wh; });
+    auto p = std::find_if(workspaces.begin(), workspaces.end(), [wh](auto const& e) { return e.handle == wh; });
     if (p != workspaces.end())
     {
-        if (auto const wksp = p->first.lock())
+        if (auto const wksp = p->workspace.lock())
         {
             ::activate(wksp);
         }
@@ -372,10 +484,12 @@ void miriway::ExtWorkspaceManagerV1::Global::bind(wl_resource* new_ext_workspace
     }
     {
         std::lock_guard lock(all_the_workspaces_mutex);
-        for (auto const& [wksp, state]: all_the_workspaces)
+        for (auto const& [wksp, info]: all_the_workspaces)
         {
             the_workspace_manager->workspace_created(wksp);
-            if (state == WkspState::active)
+            if (info.output_id)
+                the_workspace_manager->workspace_assigned(wksp, *info.output_id, info.position);
+            if (info.state == WkspState::active)
                 the_workspace_manager->workspace_activated(wksp);
             else
                 the_workspace_manager->workspace_deactivated(wksp);
@@ -445,6 +559,22 @@ void miriway::ExtWorkspaceManagerV1::Global::workspace_activated(std::shared_ptr
         });
 }
 
+void miriway::ExtWorkspaceManagerV1::Global::workspace_assigned(
+    std::shared_ptr<Workspace> const& wksp, int output_id, unsigned position)
+{
+    context->run_on_wayland_mainloop([this, wksp, output_id, position]
+        {
+            for (auto const& the_workspace_manager : the_workspace_managers)
+            {
+                if (the_workspace_manager)
+                {
+                    the_workspace_manager.value().workspace_assigned(wksp, output_id, position);
+                    the_workspace_manager.value().send_done_event();
+                }
+            }
+        });
+}
+
 void miriway::ExtWorkspaceManagerV1::Global::workspace_created(std::shared_ptr<Workspace> const& wksp)
 {
     context->run_on_wayland_mainloop([this, wksp]
@@ -30,6 +30,7 @@ class ExtWorkspaceV1 : public WorkspaceHooks
 {
 public:
     void on_workspace_create(std::shared_ptr<Workspace> const& wksp) override;
+    void on_workspace_assign(std::shared_ptr<Workspace> const& wksp, Output const& output, unsigned position) override;
     void on_workspace_activate(std::shared_ptr<Workspace> const& wksp) override;
     void on_workspace_deactivate(std::shared_ptr<Workspace> const& wksp) override;
     void on_workspace_destroy(std::shared_ptr<Workspace> const& wksp) override;
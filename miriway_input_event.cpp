@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_input_event.h"
+
+miriway::InputEvent::InputEvent(MirEvent const* event) :
+    event{event}
+{
+    if (mir_event_get_type(event) != mir_event_type_input)
+        return;
+
+    auto const* input_event = mir_event_get_input_event(event);
+    event_time = std::chrono::nanoseconds{mir_input_event_get_event_time(input_event)};
+
+    switch (mir_input_event_get_type(input_event))
+    {
+    case mir_input_event_type_key:
+        type = Type::key;
+        key_event = mir_input_event_get_keyboard_event(input_event);
+        key_action = mir_keyboard_event_action(key_event);
+        modifiers = mir_keyboard_event_modifiers(key_event);
+        keysym = mir_keyboard_event_keysym(key_event);
+        scan_code = mir_keyboard_event_scan_code(key_event);
+        break;
+
+    case mir_input_event_type_pointer:
+        type = Type::pointer;
+        pointer_event = mir_input_event_get_pointer_event(input_event);
+        modifiers = mir_pointer_event_modifiers(pointer_event);
+        pointer_action = mir_pointer_event_action(pointer_event);
+        pointer_buttons = mir_pointer_event_buttons(pointer_event);
+        vscroll_discrete = mir_pointer_event_axis_value(pointer_event, mir_pointer_axis_vscroll_discrete);
+        hscroll_discrete = mir_pointer_event_axis_value(pointer_event, mir_pointer_axis_hscroll_discrete);
+        break;
+
+    case mir_input_event_type_touch:
+        type = Type::touch;
+        touch_event = mir_input_event_get_touch_event(input_event);
+        modifiers = mir_touch_event_modifiers(touch_event);
+        break;
+
+    default:;
+    }
+}
+
+miriway::InputEvent::InputEvent(Type type, std::chrono::nanoseconds event_time, MirInputEventModifiers modifiers) :
+    event{nullptr},
+    type{type},
+    modifiers{modifiers},
+    event_time{event_time}
+{
+}
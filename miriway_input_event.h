@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_INPUT_EVENT_H
+#define MIRIWAY_INPUT_EVENT_H
+
+#include <miral/toolkit_event.h>
+
+#include <chrono>
+
+namespace miriway
+{
+using namespace miral::toolkit;
+
+// An input event decoded once by Miriway's event filter, so that the consumers
+// (AppSwitcher, ShellCommands, Magnifier) don't each repeat the work.
+struct InputEvent
+{
+    explicit InputEvent(MirEvent const* event);
+
+    enum class Type { other, key, pointer, touch };
+
+    // An event without an underlying MirEvent (e.g. one being replayed): the caller fills in the details
+    InputEvent(Type type, std::chrono::nanoseconds event_time, MirInputEventModifiers modifiers);
+
+    MirEvent const* const event;
+    Type type = Type::other;
+    MirInputEventModifiers modifiers = 0;
+    std::chrono::nanoseconds event_time{};
+
+    // Only set for Type::key
+    MirKeyboardEvent const* key_event = nullptr;
+    MirKeyboardAction key_action = mir_keyboard_action_up;
+    xkb_keysym_t keysym = 0;
+    int scan_code = 0;
+
+    // Only set for Type::pointer
+    MirPointerEvent const* pointer_event = nullptr;
+    MirPointerAction pointer_action = mir_pointer_action_motion;
+    MirPointerButtons pointer_buttons = 0;
+    float vscroll_discrete = 0;
+    float hscroll_discrete = 0;
+
+    // Only set for Type::touch
+    MirTouchEvent const* touch_event = nullptr;
+
+    [[nodiscard]] auto is_key_down() const -> bool
+        { return type == Type::key && key_action == mir_keyboard_action_down; }
+};
+}
+
+#endif //MIRIWAY_INPUT_EVENT_H
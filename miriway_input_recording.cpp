@@ -0,0 +1,180 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_input_recording.h"
+
+#include <mir/log.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+char const magic[8] = {'M', 'I', 'R', 'I', 'W', 'A', 'Y', '2'};
+
+enum class RecordType : std::uint8_t { key, pointer };
+
+struct Record
+{
+    std::int64_t event_time;    // ns
+    std::int64_t device_id;
+    std::uint32_t modifiers;
+    RecordType type;
+    std::uint8_t action;        // MirKeyboardAction or MirPointerAction
+    std::uint16_t reserved;
+    std::uint32_t keysym;
+    std::int32_t scan_code;
+    std::uint32_t buttons;
+    float x;
+    float y;
+    float vscroll;              // discrete
+    float hscroll;              // discrete
+    std::uint32_t reserved2;
+};
+
+static_assert(sizeof(Record) == 56);
+
+auto to_input_event(Record const& record) -> miriway::InputEvent
+{
+    using miriway::InputEvent;
+
+    switch (record.type)
+    {
+    case RecordType::key:
+    {
+        InputEvent event{InputEvent::Type::key, std::chrono::nanoseconds{record.event_time}, record.modifiers};
+        event.key_action = static_cast<MirKeyboardAction>(record.action);
+        event.keysym = record.keysym;
+        event.scan_code = record.scan_code;
+        return event;
+    }
+
+    case RecordType::pointer:
+    {
+        InputEvent event{InputEvent::Type::pointer, std::chrono::nanoseconds{record.event_time}, record.modifiers};
+        event.pointer_action = static_cast<MirPointerAction>(record.action);
+        event.pointer_buttons = record.buttons;
+        event.vscroll_discrete = record.vscroll;
+        event.hscroll_discrete = record.hscroll;
+        return event;
+    }
+    }
+
+    return InputEvent{InputEvent::Type::other, std::chrono::nanoseconds{record.event_time}, record.modifiers};
+}
+}
+
+miriway::InputRecorder::InputRecorder(std::filesystem::path const& file) :
+    out{file, std::ios::binary | std::ios::trunc}
+{
+    if (!out)
+    {
+        mir::log_warning("Cannot record input to %s", file.c_str());
+        return;
+    }
+
+    out.write(magic, sizeof magic);
+    mir::log_info("Recording input to %s", file.c_str());
+}
+
+miriway::InputRecorder::~InputRecorder()
+{
+    out.flush();
+}
+
+void miriway::InputRecorder::record(InputEvent const& event)
+{
+    Record record{};
+    record.event_time = event.event_time.count();
+    record.modifiers = event.modifiers;
+
+    switch (event.type)
+    {
+    case InputEvent::Type::key:
+        record.type = RecordType::key;
+        record.action = event.key_action;
+        record.keysym = event.keysym;
+        record.scan_code = event.scan_code;
+        record.device_id = mir_input_event_get_device_id(mir_keyboard_event_input_event(event.key_event));
+        break;
+
+    case InputEvent::Type::pointer:
+    {
+        auto const pev = event.pointer_event;
+        record.type = RecordType::pointer;
+        record.action = event.pointer_action;
+        record.buttons = event.pointer_buttons;
+        record.x = mir_pointer_event_axis_value(pev, mir_pointer_axis_x);
+        record.y = mir_pointer_event_axis_value(pev, mir_pointer_axis_y);
+        record.vscroll = event.vscroll_discrete;
+        record.hscroll = event.hscroll_discrete;
+        record.device_id = mir_input_event_get_device_id(mir_pointer_event_input_event(pev));
+        break;
+    }
+
+    default:
+        return;
+    }
+
+    std::lock_guard lock{mutex};
+    out.write(reinterpret_cast<char const*>(&record), sizeof record);
+}
+
+auto miriway::replay_input(std::filesystem::path const& file, std::function<bool(InputEvent const&)> const& filter) -> bool
+{
+    std::ifstream in{file, std::ios::binary};
+
+    char header[sizeof magic];
+    if (!in.read(header, sizeof header) || memcmp(header, magic, sizeof magic) != 0)
+    {
+        mir::log_warning("Cannot replay input from %s: not an input recording", file.c_str());
+        return false;
+    }
+
+    // Decode everything up front so that only the filter is timed
+    std::vector<InputEvent> events;
+    Record record;
+    while (in.read(reinterpret_cast<char*>(&record), sizeof record))
+    {
+        events.push_back(to_input_event(record));
+    }
+
+    if (events.empty())
+    {
+        mir::log_info("No input to replay from %s", file.c_str());
+        return true;
+    }
+
+    std::size_t consumed = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for (auto& event : events)
+    {
+        // The recorded times are long past: stamp each event as it is replayed (so that latency
+        // is measured from the replay, not from the recording)
+        event.event_time = std::chrono::steady_clock::now().time_since_epoch();
+        if (filter(event))
+            ++consumed;
+    }
+    auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    mir::log_info("Replayed %zu input events (%zu consumed) from %s in %.6fs: %.0f events/s, %.3fus/event",
+        events.size(), consumed, file.c_str(), elapsed, events.size()/elapsed, 1e6*elapsed/events.size());
+    return true;
+}
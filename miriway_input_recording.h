@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_INPUT_RECORDING_H
+#define MIRIWAY_INPUT_RECORDING_H
+
+#include "miriway_input_event.h"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+
+namespace miriway
+{
+// Records the key and pointer events reaching Miriway's event filter to a file of fixed size
+// binary records (in native byte order) that can be fed back through the filter by `replay_input()`.
+class InputRecorder
+{
+public:
+    explicit InputRecorder(std::filesystem::path const& file);
+    ~InputRecorder();
+
+    void record(InputEvent const& event);
+
+private:
+    std::mutex mutex;
+    std::ofstream out;
+
+    InputRecorder(InputRecorder const&) = delete;
+    InputRecorder& operator=(InputRecorder const&) = delete;
+};
+
+// Feed a recording through `filter` as fast as possible and log the events per second and
+// the mean cost per event. Each event is given the time it is replayed as its event time.
+// Returns false if the recording cannot be read.
+auto replay_input(std::filesystem::path const& file, std::function<bool(InputEvent const&)> const& filter) -> bool;
+}
+
+#endif //MIRIWAY_INPUT_RECORDING_H
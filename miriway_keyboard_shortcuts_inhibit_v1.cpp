@@ -0,0 +1,299 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_keyboard_shortcuts_inhibit_v1.h"
+#include "wayland-generated/keyboard-shortcuts-inhibit-unstable-v1_wrapper.h"
+
+#include <miral/window.h>
+#include <miral/wayland_extensions.h>
+
+#include <mir/wayland/protocol_error.h>
+#include <mir/wayland/weak.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace miriway
+{
+class KeyboardShortcutsInhibitManagerV1 : public mir::wayland::KeyboardShortcutsInhibitManagerV1
+{
+public:
+    KeyboardShortcutsInhibitManagerV1(wl_resource* new_resource, miral::WaylandExtensions::Context const* context);
+
+    class Global;
+
+private:
+    void inhibit_shortcuts(wl_resource* id, wl_resource* surface, wl_resource* seat) override;
+
+    miral::WaylandExtensions::Context const* const context;
+};
+
+class KeyboardShortcutsInhibitManagerV1::Global : public mir::wayland::KeyboardShortcutsInhibitManagerV1::Global
+{
+public:
+    explicit Global(miral::WaylandExtensions::Context const* context);
+    void bind(wl_resource* new_resource) override;
+
+private:
+    miral::WaylandExtensions::Context const* const context;
+};
+
+class KeyboardShortcutsInhibitorV1 : public mir::wayland::KeyboardShortcutsInhibitorV1
+{
+public:
+    KeyboardShortcutsInhibitorV1(
+        wl_resource* id,
+        wl_resource* surface,
+        miral::Window const& window,
+        miral::WaylandExtensions::Context const* context);
+    ~KeyboardShortcutsInhibitorV1();
+
+    // The surface, while it is waiting to become a window (null once it has, or is destroyed)
+    auto pending_surface() const -> wl_resource* { return surface_listener.surface; }
+
+    // Look again for the window of a pending surface (on the Wayland thread)
+    auto adopt_window() -> bool;
+
+    miral::Window window;
+    miral::WaylandExtensions::Context const* const context;
+
+private:
+    struct SurfaceListener
+    {
+        wl_listener listener;
+        wl_resource* surface;
+    } surface_listener{};
+
+    static void surface_destroyed(wl_listener* listener, void* data);
+};
+}
+
+namespace
+{
+// Inhibitors are created and destroyed on the Wayland thread, focus is tracked "server side"
+// and `inhibited` is read on the input thread
+std::mutex inhibitors_mutex;
+std::map<miral::Window, miriway::KeyboardShortcutsInhibitorV1*> inhibitors;
+std::vector<miriway::KeyboardShortcutsInhibitorV1*> pending;    // For surfaces that weren't yet windows
+miral::Window focused;
+std::atomic<bool> inhibited = false;
+
+void send_on_wayland_mainloop(miriway::KeyboardShortcutsInhibitorV1* inhibitor, bool active)
+{
+    inhibitor->context->run_on_wayland_mainloop([inhibitor=mir::wayland::Weak<miriway::KeyboardShortcutsInhibitorV1>{inhibitor}, active]
+        {
+            if (inhibitor)
+            {
+                if (active)
+                    inhibitor.value().send_active_event();
+                else
+                    inhibitor.value().send_inactive_event();
+            }
+        });
+}
+
+// Track any pending inhibitor whose surface has become a window (on the Wayland thread)
+void adopt_pending()
+{
+    std::lock_guard lock{inhibitors_mutex};
+    std::erase_if(pending, [](miriway::KeyboardShortcutsInhibitorV1* inhibitor)
+        {
+            if (!inhibitor->pending_surface())
+                return true;    // The surface has gone, so it never will be a window
+
+            if (!inhibitor->adopt_window())
+                return false;
+
+            if (inhibitors.contains(inhibitor->window))
+                return true;    // Another inhibitor got there first
+
+            inhibitors[inhibitor->window] = inhibitor;
+            if (inhibitor->window == focused && !inhibited.exchange(true))
+            {
+                inhibitor->send_active_event();
+            }
+            return true;
+        });
+}
+}
+
+miriway::KeyboardShortcutsInhibitManagerV1::KeyboardShortcutsInhibitManagerV1(
+    wl_resource* new_resource,
+    miral::WaylandExtensions::Context const* context) :
+    mir::wayland::KeyboardShortcutsInhibitManagerV1{new_resource, Version<1>{}},
+    context{context}
+{
+}
+
+void miriway::KeyboardShortcutsInhibitManagerV1::inhibit_shortcuts(wl_resource* id, wl_resource* surface, wl_resource* /*seat*/)
+{
+    // Miriway has a single seat, so the seat is ignored
+    auto const window = miral::window_for(surface);
+
+    std::lock_guard lock{inhibitors_mutex};
+    if ((window && inhibitors.contains(window)) ||
+        std::ranges::any_of(pending, [surface](auto const* p) { return p->pending_surface() == surface; }))
+    {
+        throw mir::wayland::ProtocolError{
+            resource, Error::already_inhibited, "Keyboard shortcuts already inhibited for this surface"};
+    }
+
+    auto const inhibitor = new KeyboardShortcutsInhibitorV1{id, surface, window, context};
+
+    if (!window)
+    {
+        // Not (yet) a window: look again when focus changes
+        pending.push_back(inhibitor);
+        return;
+    }
+
+    inhibitors[window] = inhibitor;
+    if (window == focused && !inhibited.exchange(true))
+    {
+        inhibitor->send_active_event();
+    }
+}
+
+miriway::KeyboardShortcutsInhibitManagerV1::Global::Global(miral::WaylandExtensions::Context const* context) :
+    mir::wayland::KeyboardShortcutsInhibitManagerV1::Global{context->display(), Version<1>{}},
+    context{context}
+{
+}
+
+void miriway::KeyboardShortcutsInhibitManagerV1::Global::bind(wl_resource* new_resource)
+{
+    new KeyboardShortcutsInhibitManagerV1{new_resource, context};
+}
+
+miriway::KeyboardShortcutsInhibitorV1::KeyboardShortcutsInhibitorV1(
+    wl_resource* id,
+    wl_resource* surface,
+    miral::Window const& window,
+    miral::WaylandExtensions::Context const* context) :
+    mir::wayland::KeyboardShortcutsInhibitorV1{id, Version<1>{}},
+    window{window},
+    context{context}
+{
+    if (!window)
+    {
+        surface_listener.surface = surface;
+        surface_listener.listener.notify = &surface_destroyed;
+        wl_resource_add_destroy_listener(surface, &surface_listener.listener);
+    }
+}
+
+auto miriway::KeyboardShortcutsInhibitorV1::adopt_window() -> bool
+{
+    if (!surface_listener.surface)
+        return false;
+
+    window = miral::window_for(surface_listener.surface);
+    if (!window)
+        return false;
+
+    wl_list_remove(&surface_listener.listener.link);
+    surface_listener.surface = nullptr;
+    return true;
+}
+
+void miriway::KeyboardShortcutsInhibitorV1::surface_destroyed(wl_listener* listener, void* /*data*/)
+{
+    auto const self = reinterpret_cast<SurfaceListener*>(listener);
+    wl_list_remove(&self->listener.link);
+    self->surface = nullptr;
+}
+
+miriway::KeyboardShortcutsInhibitorV1::~KeyboardShortcutsInhibitorV1()
+{
+    std::lock_guard lock{inhibitors_mutex};
+    if (surface_listener.surface)
+    {
+        wl_list_remove(&surface_listener.listener.link);
+    }
+    std::erase(pending, this);
+
+    if (auto const i = inhibitors.find(window); i != inhibitors.end() && i->second == this)
+    {
+        inhibitors.erase(i);
+        if (window == focused)
+            inhibited = false;
+    }
+}
+
+auto miriway::keyboard_shortcuts_inhibited() -> bool
+{
+    return inhibited.load(std::memory_order_relaxed);
+}
+
+void miriway::keyboard_shortcuts_inhibit_escape()
+{
+    std::lock_guard lock{inhibitors_mutex};
+    if (inhibited.exchange(false))
+    {
+        if (auto const i = inhibitors.find(focused); i != inhibitors.end())
+            send_on_wayland_mainloop(i->second, false);
+    }
+}
+
+void miriway::keyboard_shortcuts_inhibit_focus(miral::Window const& window)
+{
+    std::lock_guard lock{inhibitors_mutex};
+    if (window == focused)
+        return;
+
+    // Only the focused window's inhibitor can be active (and then `inhibited` is set): losing
+    // focus makes it inactive, gaining focus makes it active
+    if (inhibited.exchange(false))
+    {
+        if (auto const i = inhibitors.find(focused); i != inhibitors.end())
+            send_on_wayland_mainloop(i->second, false);
+    }
+
+    focused = window;
+
+    if (auto const i = inhibitors.find(focused); i != inhibitors.end())
+    {
+        inhibited = true;
+        send_on_wayland_mainloop(i->second, true);
+    }
+    else
+    {
+        // The window may be the surface of an inhibitor created before it was a window
+        if (focused && !pending.empty())
+        {
+            pending.front()->context->run_on_wayland_mainloop([] { adopt_pending(); });
+        }
+    }
+}
+
+auto miriway::build_keyboard_shortcuts_inhibit_v1_global() -> miral::WaylandExtensions::Builder
+{
+    return miral::WaylandExtensions::Builder
+    {
+        .name = KeyboardShortcutsInhibitManagerV1::interface_name,
+        .build = [](auto* context) { return std::make_shared<KeyboardShortcutsInhibitManagerV1::Global>(context); }
+    };
+}
+
+auto miriway::keyboard_shortcuts_inhibit_v1_name() -> char const*
+{
+    return KeyboardShortcutsInhibitManagerV1::interface_name;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_KEYBOARD_SHORTCUTS_INHIBIT_V1_H
+#define MIRIWAY_KEYBOARD_SHORTCUTS_INHIBIT_V1_H
+
+#include <miral/wayland_extensions.h>
+
+namespace miral { class Window; }
+namespace miriway
+{
+auto keyboard_shortcuts_inhibit_v1_name() -> char const*;
+auto build_keyboard_shortcuts_inhibit_v1_global() -> miral::WaylandExtensions::Builder;
+
+// Whether the window with keyboard focus is inhibiting Miriway's shortcuts (cheap enough for the input path)
+auto keyboard_shortcuts_inhibited() -> bool;
+
+// Restore Miriway's shortcuts while the current window keeps focus
+void keyboard_shortcuts_inhibit_escape();
+
+// Keep track of the window with keyboard focus (null for none)
+void keyboard_shortcuts_inhibit_focus(miral::Window const& window);
+} // miriway
+
+#endif //MIRIWAY_KEYBOARD_SHORTCUTS_INHIBIT_V1_H
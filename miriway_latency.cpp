@@ -0,0 +1,214 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_latency.h"
+
+#include <miral/runner.h>
+
+#include <mir/log.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <csignal>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+namespace
+{
+using namespace std::chrono;
+using miriway::latency::ActionId;
+using miriway::latency::Stage;
+
+// Bucket 0 is [0, 1µs), bucket n is [2^(n-1), 2^n) µs and the last bucket catches everything longer
+std::size_t constexpr bucket_count = 28;
+std::size_t constexpr stage_count = 3;
+ActionId constexpr max_actions = 64;
+
+char const* const stage_names[stage_count] = {"locked", "completed", "returned"};
+
+struct Histogram
+{
+    std::array<std::atomic<std::uint32_t>, bucket_count> buckets{};
+
+    void add(nanoseconds latency)
+    {
+        auto const us = static_cast<std::uint64_t>(std::max<std::int64_t>(duration_cast<microseconds>(latency).count(), 0));
+        auto const bucket = std::min<std::size_t>(std::bit_width(us), bucket_count - 1);
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+std::array<std::array<Histogram, stage_count>, max_actions> histograms;
+
+std::mutex action_names_mutex;
+std::array<std::string, max_actions> action_names;
+ActionId actions_registered = 0;
+
+auto upper_bound_us(std::size_t bucket) -> std::uint64_t
+{
+    return std::uint64_t{1} << bucket;
+}
+
+void dump_histogram(std::ostream& out, std::string const& name, std::size_t stage, Histogram const& histogram)
+{
+    std::array<std::uint32_t, bucket_count> counts;
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i != bucket_count; ++i)
+    {
+        total += counts[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+    }
+
+    if (!total) return;
+
+    auto percentile = [&](std::uint64_t percent)
+        {
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i != bucket_count; ++i)
+            {
+                seen += counts[i];
+                if (100*seen >= percent*total) return upper_bound_us(i);
+            }
+            return upper_bound_us(bucket_count - 1);
+        };
+
+    out << name << ' ' << stage_names[stage] << " count=" << total
+        << " p50<" << percentile(50) << "us p90<" << percentile(90) << "us p99<" << percentile(99) << "us :";
+
+    for (std::size_t i = 0; i != bucket_count; ++i)
+    {
+        if (counts[i]) out << " <" << upper_bound_us(i) << "us=" << counts[i];
+    }
+    out << '\n';
+}
+}
+
+thread_local miriway::latency::Probe* miriway::latency::Probe::current = nullptr;
+
+auto miriway::latency::register_action(std::string const& name) -> ActionId
+{
+    std::lock_guard lock{action_names_mutex};
+
+    for (ActionId i = 0; i != actions_registered; ++i)
+    {
+        if (action_names[i] == name) return i;
+    }
+
+    if (actions_registered < max_actions-1)
+    {
+        action_names[actions_registered] = name;
+        return actions_registered++;
+    }
+
+    // Share the last slot between any actions that don't fit
+    action_names[max_actions-1] = "(other)";
+    actions_registered = max_actions;
+    return max_actions-1;
+}
+
+miriway::latency::Probe::Probe(std::chrono::nanoseconds event_time) :
+    previous{current},
+    event_time{event_time},
+    action{}
+{
+    current = this;
+}
+
+miriway::latency::Probe::Probe(Context const& context) :
+    previous{current},
+    event_time{context.event_time},
+    action{context.action.value_or(0)},
+    has_action{context.action.has_value()},
+    resumed{true}
+{
+    current = this;
+}
+
+miriway::latency::Probe::~Probe()
+{
+    if (!resumed)
+        mark(Stage::returned);
+    current = previous;
+}
+
+auto miriway::latency::Probe::context() -> Context
+{
+    if (current && current->has_action)
+        return {current->event_time, current->action};
+
+    return {nanoseconds{}, std::nullopt};
+}
+
+void miriway::latency::Probe::set_action(ActionId action)
+{
+    if (current)
+    {
+        current->action = action;
+        current->has_action = true;
+    }
+}
+
+void miriway::latency::Probe::mark(Stage stage)
+{
+    if (current && current->has_action)
+    {
+        auto const now = steady_clock::now().time_since_epoch();
+        histograms[current->action][static_cast<std::size_t>(stage)].add(now - current->event_time);
+    }
+}
+
+void miriway::latency::dump(std::ostream& out)
+{
+    std::lock_guard lock{action_names_mutex};
+
+    for (ActionId action = 0; action != actions_registered; ++action)
+    {
+        for (std::size_t stage = 0; stage != stage_count; ++stage)
+        {
+            dump_histogram(out, action_names[action], stage, histograms[action][stage]);
+        }
+    }
+}
+
+miriway::latency::DumpOnSignal::DumpOnSignal(miral::MirRunner& runner)
+{
+    runner.add_start_callback([&runner]
+        {
+            runner.register_signal_handler({SIGUSR2}, [](int)
+                {
+                    if (auto const runtime_dir = getenv("XDG_RUNTIME_DIR"))
+                    {
+                        auto const path = std::filesystem::path{runtime_dir} / "miriway-latency";
+                        if (std::ofstream out{path})
+                        {
+                            dump(out);
+                            mir::log_info("Latency histograms written to %s", path.c_str());
+                            return;
+                        }
+                    }
+
+                    std::ostringstream out;
+                    dump(out);
+                    mir::log_info("Latency histograms:\n%s", out.str().c_str());
+                });
+        });
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_LATENCY_H
+#define MIRIWAY_LATENCY_H
+
+#include <chrono>
+#include <optional>
+#include <ostream>
+#include <string>
+
+namespace miral { class MirRunner; }
+
+// Histograms of the time from the timestamp on an input event to the stages of the action it triggers.
+//
+// Recording is allocation free: each (action, stage) pair has a fixed set of log2 scale buckets of
+// atomic counters. Actions are registered (by name) when the configuration is loaded.
+namespace miriway::latency
+{
+using ActionId = unsigned;
+
+enum class Stage
+{
+    locked,     // The window manager lock has been acquired
+    completed,  // The action has finished
+    returned,   // The input filter has returned
+};
+
+auto register_action(std::string const& name) -> ActionId;
+
+// What a probe is measuring, so that the measurement can be continued on another thread
+struct Context
+{
+    std::chrono::nanoseconds event_time;
+    std::optional<ActionId> action;
+};
+
+// Marks the stages of the action triggered by an input event processed on this thread
+class Probe
+{
+public:
+    explicit Probe(std::chrono::nanoseconds event_time);
+
+    // Continue measuring on this thread: `returned` is not marked (that belongs to the input thread)
+    explicit Probe(Context const& context);
+    ~Probe();
+
+    // The context of the current probe (if any)
+    static auto context() -> Context;
+
+    // Identify the action being triggered by the current probe (if any)
+    static void set_action(ActionId action);
+
+    // Record a stage of the action being triggered by the current probe (if any)
+    static void mark(Stage stage);
+
+private:
+    Probe* const previous;
+    std::chrono::nanoseconds const event_time;
+    ActionId action;
+    bool has_action = false;
+    bool const resumed = false;
+
+    static thread_local Probe* current;
+
+    Probe(Probe const&) = delete;
+    Probe& operator=(Probe const&) = delete;
+};
+
+// Marks `locked` on construction and `completed` on destruction
+class UnderLock
+{
+public:
+    UnderLock() { Probe::mark(Stage::locked); }
+    ~UnderLock() { Probe::mark(Stage::completed); }
+
+private:
+    UnderLock(UnderLock const&) = delete;
+    UnderLock& operator=(UnderLock const&) = delete;
+};
+
+void dump(std::ostream& out);
+
+// Dump the histograms to "$XDG_RUNTIME_DIR/miriway-latency" (or the log) on SIGUSR2
+class DumpOnSignal
+{
+public:
+    explicit DumpOnSignal(miral::MirRunner& runner);
+};
+}
+
+#endif //MIRIWAY_LATENCY_H
@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_launch_limiter.h"
+
+#include <mir/log.h>
+
+#include <signal.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <numeric>
+
+namespace
+{
+int constexpr default_min_interval_ms = 0;
+int constexpr default_max_in_flight = 0;
+
+// A process that has neither mapped a window nor exited by now isn't going to map one soon
+auto constexpr in_flight_timeout = std::chrono::seconds{10};
+
+auto to_string(std::vector<std::string> const& command_line) -> std::string
+{
+    return std::accumulate(command_line.begin(), command_line.end(), std::string{},
+        [](std::string const& result, std::string const& arg) { return result.empty() ? arg : result + ' ' + arg; });
+}
+}
+
+miriway::LaunchLimiter::LaunchLimiter(live_config::Store& store) :
+    min_interval{default_min_interval_ms},
+    max_in_flight{default_max_in_flight}
+{
+    store.add_int_attribute(
+        live_config::Key{{"launch", "min_interval"}},
+        "Minimum interval (in milliseconds) between launches from the same shortcut (0 for no limit)",
+        default_min_interval_ms,
+        [this](live_config::Key const& key, std::optional<int> value)
+        {
+            if (value && *value < 0)
+            {
+                mir::log_warning("Config value %s is negative, ignoring", key.to_string().c_str());
+                return;
+            }
+
+            std::lock_guard lock{mutex};
+            min_interval = std::chrono::milliseconds{value.value_or(default_min_interval_ms)};
+        });
+
+    store.add_int_attribute(
+        live_config::Key{{"launch", "max_in_flight"}},
+        "Maximum launches from the same shortcut that have not yet mapped a window (0 for no limit)",
+        default_max_in_flight,
+        [this](live_config::Key const& key, std::optional<int> value)
+        {
+            if (value && *value < 0)
+            {
+                mir::log_warning("Config value %s is negative, ignoring", key.to_string().c_str());
+                return;
+            }
+
+            std::lock_guard lock{mutex};
+            max_in_flight = value.value_or(default_max_in_flight);
+        });
+}
+
+auto miriway::LaunchLimiter::binding_for(std::vector<std::string> const& command_line) -> std::shared_ptr<Binding>
+{
+    std::lock_guard lock{mutex};
+    std::erase_if(bindings, [](std::weak_ptr<Binding> const& binding) { return binding.expired(); });
+
+    for (auto const& weak : bindings)
+    {
+        if (auto const binding = weak.lock(); binding && binding->command_line == command_line)
+            return binding;
+    }
+
+    auto const binding = std::make_shared<Binding>(command_line);
+    bindings.push_back(binding);
+    return binding;
+}
+
+auto miriway::LaunchLimiter::permit(Binding& binding) -> bool
+{
+    std::lock_guard lock{mutex};
+    if (!limited())
+        return true;
+
+    auto const now = Clock::now();
+    expire_in_flight(binding, now);
+
+    if (now - binding.last_launch >= min_interval &&
+        (max_in_flight == 0 || binding.in_flight.size() < static_cast<std::size_t>(max_in_flight)))
+    {
+        binding.last_launch = now;
+        return true;
+    }
+
+    // Log the 1st, 2nd, 4th, 8th... suppression: a stuck key shouldn't flood the log either
+    if (std::has_single_bit(++binding.suppressed))
+    {
+        mir::log_warning("Launch of \"%s\" suppressed (%u so far): %zu launches still pending",
+            to_string(binding.command_line).c_str(), binding.suppressed, binding.in_flight.size());
+    }
+    return false;
+}
+
+void miriway::LaunchLimiter::launched(Binding& binding, pid_t pid)
+{
+    if (pid <= 0)
+        return;
+
+    std::lock_guard lock{mutex};
+    if (max_in_flight > 0)
+    {
+        binding.in_flight.emplace_back(pid, Clock::now());
+    }
+}
+
+void miriway::LaunchLimiter::advise_window_for(pid_t pid)
+{
+    std::lock_guard lock{mutex};
+    for (auto const& weak : bindings)
+    {
+        if (auto const binding = weak.lock())
+        {
+            std::erase_if(binding->in_flight, [pid](auto const& launch) { return launch.first == pid; });
+        }
+    }
+}
+
+void miriway::LaunchLimiter::expire_in_flight(Binding& binding, Clock::time_point now)
+{
+    std::erase_if(binding.in_flight, [now](auto const& launch)
+        {
+            auto const [pid, when] = launch;
+            return now - when > in_flight_timeout || (kill(pid, 0) == -1 && errno == ESRCH);
+        });
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_LAUNCH_LIMITER_H
+#define MIRIWAY_LAUNCH_LIMITER_H
+
+#include <miral/live_config.h>
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace miriway
+{
+using namespace miral;
+
+// Protects against "spawn storms" (e.g. from a stuck key) on launch shortcuts.
+//
+// For each command line there is a minimum interval between launches and a limit on the
+// launches "in flight" (processes that have neither mapped a window nor exited). Launches
+// beyond these are suppressed, counted and logged. Both limits are off by default, as many
+// launch shortcuts (e.g. for volume or brightness keys) are meant to be repeated quickly.
+class LaunchLimiter
+{
+public:
+    explicit LaunchLimiter(live_config::Store& store);
+
+    // The launch state of a shortcut
+    struct Binding;
+
+    // The state for launching `command_line` (called as the configuration is loaded, so the
+    // input path doesn't need to look it up). The same command line keeps the same state.
+    auto binding_for(std::vector<std::string> const& command_line) -> std::shared_ptr<Binding>;
+
+    // Whether `binding` may be launched now
+    auto permit(Binding& binding) -> bool;
+
+    // `binding` has been launched as `pid`
+    void launched(Binding& binding, pid_t pid);
+
+    // `pid` has mapped a window, so is no longer in flight
+    void advise_window_for(pid_t pid);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::mutex mutex;
+    std::chrono::milliseconds min_interval;
+    int max_in_flight;      // Zero for no limit
+    std::vector<std::weak_ptr<Binding>> bindings;
+
+    auto limited() const -> bool { return min_interval.count() > 0 || max_in_flight > 0; }
+    void expire_in_flight(Binding& binding, Clock::time_point now);
+};
+
+struct LaunchLimiter::Binding
+{
+    std::vector<std::string> const command_line;
+    Clock::time_point last_launch;
+    std::vector<std::pair<pid_t, Clock::time_point>> in_flight;
+    unsigned suppressed = 0;
+};
+}
+
+#endif //MIRIWAY_LAUNCH_LIMITER_H
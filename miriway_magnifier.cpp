@@ -17,27 +17,372 @@
  */
 
 #include "miriway_magnifier.h"
+#include "miriway_input_event.h"
 
+#include <miral/runner.h>
 #include <miral/toolkit_event.h>
 
+#include <mir/fd.h>
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+
 using namespace miral::toolkit;
+using namespace std::chrono_literals;
+
+namespace
+{
+// Each step (key press, key repeat or scroll notch) zooms by this factor
+float constexpr zoom_step = 1.25f;
+float constexpr max_magnification = 16.0f;
 
-bool miriway::Magnifier::check_on_off(MirKeyboardEvent const* key_event)
+// The default of the "magnifier_magnification" setting (owned by miral::Magnifier)
+float constexpr default_magnification = 2.0f;
+
+// Mir doesn't expose an output's frame clock, so tick at a typical refresh rate.
+// (The magnifier is composited with the frame anyway, so faster updates would be wasted.)
+auto constexpr frame_interval = std::chrono::nanoseconds{1s}/60;
+
+// The fraction of the remaining (logarithmic) distance to the target covered each frame
+float constexpr approach_rate = 0.3f;
+
+void arm(int timer_fd, std::chrono::nanoseconds interval)
 {
-    if (mir_keyboard_event_action(key_event) != mir_keyboard_action_down)
+    auto const ns = interval.count();
+    timespec const period{static_cast<time_t>(ns / 1'000'000'000), static_cast<long>(ns % 1'000'000'000)};
+    itimerspec const spec{period, period};
+    timerfd_settime(timer_fd, 0, &spec, nullptr);
+}
+
+// Forwards registrations to the underlying store unchanged, except that the handlers for
+// "magnifier_enable" and "magnifier_magnification" also report the value to Miriway's zoom.
+// (The settings stay registered once, by miral::Magnifier.)
+class ObservingStore : public miral::live_config::Store
+{
+    using Key = miral::live_config::Key;
+
+public:
+    ObservingStore(
+        Store& underlying,
+        std::function<void(bool)> on_enable,
+        std::function<void(float)> on_magnification) :
+        underlying{underlying},
+        on_enable{std::move(on_enable)},
+        on_magnification{std::move(on_magnification)}
+    {
+    }
+
+    void add_bool_attribute(Key const& key, std::string_view description, HandleBool handler) override
+    {
+        underlying.add_bool_attribute(key, description, observe_enable(key, std::move(handler)));
+    }
+
+    void add_bool_attribute(Key const& key, std::string_view description, bool preset, HandleBool handler) override
+    {
+        underlying.add_bool_attribute(key, description, preset, observe_enable(key, std::move(handler)));
+    }
+
+    void add_float_attribute(Key const& key, std::string_view description, HandleFloat handler) override
+    {
+        underlying.add_float_attribute(key, description, observe_magnification(key, std::move(handler)));
+    }
+
+    void add_float_attribute(Key const& key, std::string_view description, float preset, HandleFloat handler) override
+    {
+        underlying.add_float_attribute(key, description, preset, observe_magnification(key, std::move(handler)));
+    }
+
+    void add_int_attribute(Key const& key, std::string_view description, HandleInt handler) override
+    {
+        underlying.add_int_attribute(key, description, std::move(handler));
+    }
+
+    void add_int_attribute(Key const& key, std::string_view description, int preset, HandleInt handler) override
+    {
+        underlying.add_int_attribute(key, description, preset, std::move(handler));
+    }
+
+    void add_ints_attribute(Key const& key, std::string_view description, HandleInts handler) override
+    {
+        underlying.add_ints_attribute(key, description, std::move(handler));
+    }
+
+    void add_ints_attribute(
+        Key const& key, std::string_view description, std::span<int const> preset, HandleInts handler) override
+    {
+        underlying.add_ints_attribute(key, description, preset, std::move(handler));
+    }
+
+    void add_floats_attribute(Key const& key, std::string_view description, HandleFloats handler) override
+    {
+        underlying.add_floats_attribute(key, description, std::move(handler));
+    }
+
+    void add_floats_attribute(
+        Key const& key, std::string_view description, std::span<float const> preset, HandleFloats handler) override
+    {
+        underlying.add_floats_attribute(key, description, preset, std::move(handler));
+    }
+
+    void add_string_attribute(Key const& key, std::string_view description, HandleString handler) override
+    {
+        underlying.add_string_attribute(key, description, std::move(handler));
+    }
+
+    void add_string_attribute(
+        Key const& key, std::string_view description, std::string_view preset, HandleString handler) override
+    {
+        underlying.add_string_attribute(key, description, preset, std::move(handler));
+    }
+
+    void add_strings_attribute(Key const& key, std::string_view description, HandleStrings handler) override
+    {
+        underlying.add_strings_attribute(key, description, std::move(handler));
+    }
+
+    void add_strings_attribute(
+        Key const& key, std::string_view description, std::span<std::string const> preset, HandleStrings handler) override
+    {
+        underlying.add_strings_attribute(key, description, preset, std::move(handler));
+    }
+
+    void on_done(HandleDone handler) override
+    {
+        underlying.on_done(std::move(handler));
+    }
+
+private:
+    Store& underlying;
+    std::function<void(bool)> const on_enable;
+    std::function<void(float)> const on_magnification;
+
+    static auto is(Key const& key, std::initializer_list<std::string_view> path) -> bool
+    {
+        return key.to_string() == Key{path}.to_string();
+    }
+
+    auto observe_enable(Key const& key, HandleBool handler) const -> HandleBool
+    {
+        if (!is(key, {"magnifier", "enable"}))
+            return handler;
+
+        return [handler=std::move(handler), observer=on_enable](Key const& key, std::optional<bool> value)
+            {
+                handler(key, value);
+                observer(value.value_or(false));
+            };
+    }
+
+    auto observe_magnification(Key const& key, HandleFloat handler) const -> HandleFloat
+    {
+        if (!is(key, {"magnifier", "magnification"}))
+            return handler;
+
+        return [handler=std::move(handler), observer=on_magnification](Key const& key, std::optional<float> value)
+            {
+                handler(key, value);
+                observer(value.value_or(default_magnification));
+            };
+    }
+};
+
+// miral::Magnifier registers its settings while it is constructed, so a temporary store suffices
+auto as_lvalue(miral::live_config::Store&& store) -> miral::live_config::Store&
+{
+    return store;
+}
+}
+
+class miriway::Magnifier::Zoom
+{
+public:
+    Zoom() :
+        frame_timer{timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)}
+    {
+    }
+
+    // `magnifier` shares its state with the miriway::Magnifier that owns us
+    void attach(miral::Magnifier const& magnifier)
+    {
+        std::lock_guard lock{mutex};
+        this->magnifier = magnifier;
+    }
+
+    void start(miral::MirRunner& runner)
+    {
+        frame_handler = runner.register_fd_handler(frame_timer, [this](int fd)
+            {
+                std::uint64_t expirations;
+                while (read(fd, &expirations, sizeof expirations) > 0)
+                    ;
+                on_frame();
+            });
+    }
+
+    auto is_enabled() -> bool
+    {
+        std::lock_guard lock{mutex};
+        return enabled;
+    }
+
+    // miral::Magnifier has applied a change to the "magnifier_enable" setting
+    void configured_enabled(bool enable)
+    {
+        std::lock_guard lock{mutex};
+        if (enable != enabled)
+        {
+            settle_at(enable ? configured_magnification : 1.0f);
+            enabled = enable;
+        }
+    }
+
+    // miral::Magnifier has applied a change to the "magnifier_magnification" setting
+    void configured_magnification_changed(float magnification)
+    {
+        std::lock_guard lock{mutex};
+        configured_magnification = std::clamp(magnification, 1.0f, max_magnification);
+        if (enabled)
+        {
+            settle_at(configured_magnification);
+        }
+    }
+
+    void step(int steps)
+    {
+        std::lock_guard lock{mutex};
+
+        if (!enabled)
+        {
+            // Zooming in from off turns the magnifier on at the configured magnification
+            if (steps > 0)
+            {
+                enabled = true;
+                settle_at(configured_magnification);
+                magnifier.enable(true);
+            }
+            return;
+        }
+
+        target = std::clamp(target * std::pow(zoom_step, float(steps)), 1.0f, max_magnification);
+
+        // Start the frame tick if it isn't already running: on_frame() stops it once the target is reached
+        if (!ticking && target != current)
+        {
+            ticking = true;
+            arm(frame_timer, frame_interval);
+        }
+    }
+
+    void off()
+    {
+        std::lock_guard lock{mutex};
+        enabled = false;
+        settle_at(1.0f);
+        magnifier.enable(false);
+    }
+
+private:
+    miral::Magnifier magnifier;
+    mir::Fd const frame_timer;
+    std::unique_ptr<miral::FdHandle> frame_handler;
+
+    std::mutex mutex;
+    bool enabled = false;
+    float current = 1.0f;
+    float target = 1.0f;
+    bool ticking = false;
+    float configured_magnification = default_magnification;
+
+    // Go straight to `magnification` (stopping any animation)
+    void settle_at(float magnification)
+    {
+        current = target = magnification;
+        ticking = false;
+        arm(frame_timer, 0ns);
+        magnifier.magnification(current);
+    }
+
+    void on_frame()
+    {
+        std::lock_guard lock{mutex};
+
+        if (!ticking)
+            return;
+
+        // Approach the target geometrically, so zooming feels the same at every magnification
+        auto const remaining = std::log(target / current);
+        if (std::abs(remaining) < 0.01f)
+        {
+            current = target;
+            ticking = false;
+            arm(frame_timer, 0ns);
+        }
+        else
+        {
+            current *= std::exp(remaining * approach_rate);
+        }
+
+        if (current > 1.0f)
+        {
+            magnifier.magnification(current);
+        }
+        else
+        {
+            enabled = false;
+            magnifier.enable(false);
+        }
+    }
+};
+
+// The settings stay with miral::Magnifier: the zoom observes the values it applies, so that
+// zoom steps start from, and keep in step with, the configured state
+miriway::Magnifier::Magnifier(miral::MirRunner& runner, miral::live_config::Store& config_store) :
+    Magnifier{runner, config_store, std::make_shared<Zoom>()}
+{
+}
+
+miriway::Magnifier::Magnifier(
+    miral::MirRunner& runner, miral::live_config::Store& config_store, std::shared_ptr<Zoom> const& zoom) :
+    miral::Magnifier{as_lvalue(ObservingStore{
+        config_store,
+        [zoom](bool enable) { zoom->configured_enabled(enable); },
+        [zoom](float magnification) { zoom->configured_magnification_changed(magnification); }})},
+    zoom{zoom}
+{
+    zoom->attach(*this);
+    runner.add_start_callback([zoom, &runner] { zoom->start(runner); });
+}
+
+bool miriway::Magnifier::check_on_off(InputEvent const& key_event)
+{
+    if (key_event.type != InputEvent::Type::key || key_event.key_action == mir_keyboard_action_up)
         return false;
 
-    if (mir_keyboard_event_modifiers(key_event) & mir_input_event_modifier_meta)
+    if (key_event.modifiers & mir_input_event_modifier_meta)
     {
-        // Turn on/off the magnifier Meta+{Plus,Equal}/Meta+Escape
-        switch (mir_keyboard_event_keysym(key_event))
+        // Zoom in/out with Meta+{Plus,Equal}/Meta+Minus and turn off the magnifier with Meta+Escape
+        switch (key_event.keysym)
         {
         case XKB_KEY_plus:
         case XKB_KEY_equal:
-            enable(true);
+            zoom->step(+1);
+            return true;
+        case XKB_KEY_minus:
+            zoom->step(-1);
             return true;
         case XKB_KEY_Escape:
-            enable(false);
+            if (key_event.key_action == mir_keyboard_action_down)
+                zoom->off();
             return true;
         default:
             return false;
@@ -50,5 +395,22 @@ bool miriway::Magnifier::check_on_off(MirKeyboardEvent const* key_event)
 void miriway::Magnifier::operator()(mir::Server& server)
 {
     miral::Magnifier::operator()(server);
-    magnifier_filter(server);
+}
+
+bool miriway::Magnifier::process_event(InputEvent const& event)
+{
+    return check_on_off(event);
+}
+
+bool miriway::Magnifier::process_zoom_scroll(InputEvent const& event)
+{
+    if (event.type != InputEvent::Type::pointer || event.pointer_action != mir_pointer_action_motion)
+        return false;
+
+    if (!(event.modifiers & mir_input_event_modifier_meta) || event.vscroll_discrete == 0 || !zoom->is_enabled())
+        return false;
+
+    // Scrolling "up" (negative) zooms in
+    zoom->step(event.vscroll_discrete < 0 ? +1 : -1);
+    return true;
 }
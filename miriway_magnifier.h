@@ -19,20 +19,38 @@
 #ifndef MIRIWAY_MIRIWAY_MAGNIFIER_H
 #define MIRIWAY_MIRIWAY_MAGNIFIER_H
 
-#include <miral/append_keyboard_event_filter.h>
 #include <miral/magnifier.h>
 
+#include <memory>
+
+namespace miral { class MirRunner; }
+
 namespace miriway
 {
+struct InputEvent;
+
+// Zoom is stepped by Meta+{Plus,Equal,Minus} (holding the key repeats) and, while magnified,
+// by Meta+scroll. Each step changes a target magnification that is approached on a frame tick,
+// so however fast the input arrives the magnifier is updated at most once per frame.
 class Magnifier : miral::Magnifier
 {
-    miral::AppendKeyboardEventFilter magnifier_filter{[this](auto... args) { return check_on_off(args...); }};
-
-    bool check_on_off(MirKeyboardEvent const* key_event);
+    bool check_on_off(InputEvent const& key_event);
 public:
-    using miral::Magnifier::Magnifier;
+    Magnifier(miral::MirRunner& runner, miral::live_config::Store& config_store);
 
     void operator()(mir::Server& server);
+
+    // Called from Miriway's event filter (rather than installing a filter of our own)
+    bool process_event(InputEvent const& event);
+
+    // Called ahead of the shortcuts: while magnified, Meta+scroll zooms
+    bool process_zoom_scroll(InputEvent const& event);
+
+private:
+    class Zoom;
+    std::shared_ptr<Zoom> zoom;
+
+    Magnifier(miral::MirRunner& runner, miral::live_config::Store& config_store, std::shared_ptr<Zoom> const& zoom);
 };
 }
 
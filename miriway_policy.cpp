@@ -18,6 +18,8 @@
 
 #include "miriway_policy.h"
 #include "miriway_commands.h"
+#include "miriway_keyboard_shortcuts_inhibit_v1.h"
+#include "miriway_latency.h"
 
 #include <miral/application_info.h>
 #include <miral/window_info.h>
@@ -29,11 +31,13 @@
 using namespace mir::geometry;
 using namespace miral;
 
-miriway::WindowManagerPolicy::WindowManagerPolicy(WindowManagerTools const& tools, ShellCommands& commands) :
+miriway::WindowManagerPolicy::WindowManagerPolicy(
+    WindowManagerTools const& tools, ShellCommands& commands, AppFreezer& freezer) :
     WorkspaceWMStrategy{tools},
     commands{&commands}
 {
     commands.init_window_manager(this);
+    use_app_freezer(freezer);
 }
 
 miral::WindowSpecification miriway::WindowManagerPolicy::place_new_window(
@@ -64,11 +68,25 @@ void miriway::WindowManagerPolicy::advise_delete_window(const miral::WindowInfo
     }
 }
 
+void miriway::WindowManagerPolicy::advise_focus_gained(const miral::WindowInfo &window_info)
+{
+    WorkspaceWMStrategy::advise_focus_gained(window_info);
+    keyboard_shortcuts_inhibit_focus(window_info.window());
+}
+
+void miriway::WindowManagerPolicy::advise_focus_lost(const miral::WindowInfo &window_info)
+{
+    WorkspaceWMStrategy::advise_focus_lost(window_info);
+    keyboard_shortcuts_inhibit_focus(Window{});
+}
+
 void miriway::WindowManagerPolicy::dock_active_window_left(bool shift)
 {
     tools.invoke_under_lock(
         [this, shift]
         {
+            latency::UnderLock const timing;
+
             if (!shift)
             {
                 dock_active_window_under_lock(
@@ -87,6 +105,8 @@ void miriway::WindowManagerPolicy::toggle_maximized_restored()
     tools.invoke_under_lock(
         [this]
         {
+            latency::UnderLock const timing;
+
             if (auto active_window = tools.active_window())
             {
                 auto& window_info = tools.info_for(active_window);
@@ -123,6 +143,8 @@ void miriway::WindowManagerPolicy::toggle_always_on_top()
     tools.invoke_under_lock(
         [this]
         {
+            latency::UnderLock const timing;
+
             if (auto const w = tools.active_window())
             {
                 auto const& info = tools.info_for(w);
@@ -157,6 +179,8 @@ void miriway::WindowManagerPolicy::dock_active_window_right(bool shift)
     tools.invoke_under_lock(
         [this, shift]
         {
+            latency::UnderLock const timing;
+
             if (!shift)
             {
                 dock_active_window_under_lock(
@@ -32,6 +32,7 @@
 namespace miriway
 {
 using namespace miral;
+class AppFreezer;
 class ShellCommands;
 
 // A window management policy that adds support for docking and workspaces.
@@ -39,12 +40,19 @@ class ShellCommands;
 class WindowManagerPolicy : public WorkspaceWMStrategy<miral::FloatingWindowManager, ExtWorkspaceV1>
 {
 public:
-    WindowManagerPolicy(WindowManagerTools const& tools, ShellCommands& commands);
+    WindowManagerPolicy(WindowManagerTools const& tools, ShellCommands& commands, AppFreezer& freezer);
 
     using WorkspaceWMStrategy::workspace_begin;
     using WorkspaceWMStrategy::workspace_end;
     using WorkspaceWMStrategy::workspace_up;
     using WorkspaceWMStrategy::workspace_down;
+    using WorkspaceWMStrategy::workspace_goto;
+    using WorkspaceWMStrategy::send_to_workspace;
+    using WorkspaceWMStrategy::send_to_workspace_step;
+    using WorkspaceWMStrategy::switch_app;
+    using WorkspaceWMStrategy::switch_window;
+    using WorkspaceWMStrategy::switch_confirm;
+    using WorkspaceWMStrategy::switch_cancel;
     void dock_active_window_left(bool shift);
     void dock_active_window_right(bool shift);
     bool handle_pointer_event(const MirPointerEvent* event) override;
@@ -60,6 +68,9 @@ private:
 
     void advise_delete_window(const WindowInfo &window_info) override;
 
+    void advise_focus_gained(const WindowInfo &window_info) override;
+    void advise_focus_lost(const WindowInfo &window_info) override;
+
     void advise_application_zone_create(Zone const& application_zone) override;
     void advise_application_zone_update(Zone const& updated, Zone const& original) override;
     void advise_application_zone_delete(Zone const& application_zone) override;
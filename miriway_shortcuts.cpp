@@ -0,0 +1,257 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_shortcuts.h"
+
+#include <miral/external_client.h>
+
+#include <mir/abnormal_exit.h>
+#include <mir/fatal.h>
+
+#include <xkbcommon/xkbcommon.h>
+
+#include <algorithm>
+#include <bit>
+#include <map>
+
+namespace
+{
+auto to_key(std::string_view as_string) -> xkb_keysym_t
+{
+    if (auto const result = xkb_keysym_from_name(as_string.data(), XKB_KEYSYM_CASE_INSENSITIVE); result != XKB_KEY_NoSymbol)
+    {
+        return result;
+    }
+
+    throw mir::AbnormalExit((std::string{ "Unrecognised key in config: "} + as_string.data()).c_str());
+}
+
+using miriway::ShellCommands;
+
+std::map<std::string, ShellCommands::CmdFunctor> const wm_command = []
+{
+    std::map<std::string, ShellCommands::CmdFunctor> result
+    {
+        { "dock-left", [](ShellCommands* sc, bool shift) { sc->dock_active_window_left(shift); } },
+        { "dock-right", [](ShellCommands* sc, bool shift) { sc->dock_active_window_right(shift); } },
+        { "toggle-maximized", [](ShellCommands* sc, bool shift) { sc->toggle_maximized_restored(shift); } },
+        { "toggle-always-on-top", [](ShellCommands* sc, bool shift) { sc->toggle_always_on_top(shift); } },
+        { "workspace-begin", [](ShellCommands* sc, bool shift) { sc->workspace_begin(shift); } },
+        { "workspace-end", [](ShellCommands* sc, bool shift) { sc->workspace_end(shift); } },
+        { "workspace-up", [](ShellCommands* sc, bool shift) { sc->workspace_up(shift); } },
+        { "workspace-down", [](ShellCommands* sc, bool shift) { sc->workspace_down(shift); } },
+        { "send-to-workspace-prev", [](ShellCommands* sc, bool) { sc->send_to_workspace_step(-1); } },
+        { "send-to-workspace-next", [](ShellCommands* sc, bool) { sc->send_to_workspace_step(+1); } },
+        { "exit", [](ShellCommands* sc, bool shift) { sc->exit(shift); } },
+    };
+
+    // "workspace-N" goes directly to the Nth workspace, "move-to-workspace-N" takes the active app there
+    // and "send-to-workspace-N" sends the active app there (without switching)
+    for (auto n = 1; n <= 9; ++n)
+    {
+        result["send-to-workspace-" + std::to_string(n)] =
+            [n](ShellCommands* sc, bool) { sc->send_to_workspace(n); };
+        result["workspace-" + std::to_string(n)] =
+            [n](ShellCommands* sc, bool shift) { sc->workspace_goto(n, shift); };
+        result["move-to-workspace-" + std::to_string(n)] =
+            [n](ShellCommands* sc, bool) { sc->workspace_goto(n, true); };
+    }
+
+    return result;
+}();
+}
+
+// An open-addressed hash table (linear probing, at most half full) keyed on (modifiers, keysym).
+// It is immutable once built, so it can be shared with the input path without locking.
+class miriway::Shortcuts::Table
+{
+public:
+    Table() : Table{std::map<std::uint64_t, Action const*>{}} {}
+
+    explicit Table(std::map<std::uint64_t, Action const*> const& entries) :
+        slots(std::bit_ceil(std::max<std::size_t>(8, 2*entries.size()))),
+        mask{slots.size() - 1},
+        shift{64 - std::countr_zero(slots.size())}
+    {
+        for (auto const& [key, action] : entries)
+        {
+            auto i = home_of(key);
+            while (slots[i].key != no_key)
+            {
+                i = (i + 1) & mask;
+            }
+
+            slots[i].key = key;
+            slots[i].action = *action;
+        }
+    }
+
+    static auto key_for(Modifiers modifiers, xkb_keysym_t key_code) -> std::uint64_t
+    {
+        return (std::uint64_t(modifiers) << 32) | key_code;
+    }
+
+    auto find(std::uint64_t key) const -> Action const*
+    {
+        for (auto i = home_of(key);; i = (i + 1) & mask)
+        {
+            if (slots[i].key == key) return &slots[i].action;
+            if (slots[i].key == no_key) return nullptr;
+        }
+    }
+
+private:
+    static std::uint64_t constexpr no_key = ~std::uint64_t{};
+
+    struct Slot
+    {
+        std::uint64_t key = no_key;
+        Action action;
+    };
+
+    std::vector<Slot> slots;
+    std::size_t const mask;
+    int const shift;
+
+    // Fibonacci hashing: keysyms cluster, so spread them over the table
+    auto home_of(std::uint64_t key) const -> std::size_t
+    {
+        return (key * 0x9e3779b97f4a7c15) >> shift;
+    }
+};
+
+miriway::Shortcuts::Shortcuts(live_config::Store& store, Launch launch, Prepare prepare) :
+    launch{std::move(launch)},
+    prepare{std::move(prepare)},
+    limiter{store},
+    table{std::make_shared<Table const>()}
+{
+}
+
+void miriway::Shortcuts::add_source(
+    live_config::Store& store,
+    std::string const& option,
+    std::string const& description,
+    Modifiers modifiers,
+    bool shell)
+{
+    Source* source;
+    {
+        std::lock_guard lock{sources_mutex};
+        source = &sources.emplace_back(modifiers, shell);
+    }
+
+    auto settings_key = option;
+    std::replace(settings_key.begin(), settings_key.end(), '-', '_');
+    store.add_strings_attribute(
+        live_config::Key{{"command", settings_key}},
+        "command " + description,
+        [this, source](live_config::Key const&, std::optional<std::span<std::string const>> value)
+        {
+            std::vector<std::pair<xkb_keysym_t, Action>> bindings;
+
+            if (value) for (auto const& command : *value)
+            {
+                if (auto const split = command.find(':'); split >= 1 && split+1 < command.size())
+                {
+                    auto const key = xkb_keysym_to_lower(to_key(command.substr(0, split)));
+
+                    if (command[split+1] != '@')
+                    {
+                        auto command_line = ExternalClientLauncher::split_command(command.substr(split+1));
+                        prepare(command_line);
+                        auto launch_limit = limiter.binding_for(command_line);
+                        bindings.emplace_back(key, Action{
+                            {},
+                            std::move(command_line),
+                            source->shell,
+                            latency::register_action(command.substr(split+1)),
+                            std::move(launch_limit)});
+                    }
+                    else
+                    {
+                        if (auto const lookup = wm_command.find(command.substr(split+2)); lookup != std::end(wm_command))
+                        {
+                            bindings.emplace_back(key, Action{
+                                lookup->second, {}, false, latency::register_action(command.substr(split+1)), {}});
+                        }
+                    }
+                }
+                else
+                {
+                    mir::fatal_error("Invalid command option: %s", command.c_str());
+                }
+            }
+
+            std::lock_guard lock{sources_mutex};
+            source->bindings = std::move(bindings);
+            rebuild();
+        });
+}
+
+void miriway::Shortcuts::rebuild()
+{
+    std::map<std::uint64_t, Action const*> entries;
+
+    // Shell bindings take precedence, so they go in last (and, within a source, the last binding wins)
+    for (auto const shell : {false, true})
+    {
+        for (auto const& source : sources)
+        {
+            if (source.shell != shell) continue;
+
+            for (auto const& [key_code, action] : source.bindings)
+            {
+                entries[Table::key_for(source.modifiers, key_code)] = &action;
+            }
+        }
+    }
+
+    table.store(std::make_shared<Table const>(entries));
+}
+
+bool miriway::Shortcuts::try_command_for(
+    Modifiers modifiers, xkb_keysym_t key_code, bool with_shift, ShellCommands* cmd)
+{
+    // Hold a reference to the current snapshot: a concurrent reload publishes a new one
+    // without disturbing this lookup
+    auto const snapshot = table.load();
+
+    if (auto const action = snapshot->find(Table::key_for(modifiers, xkb_keysym_to_lower(key_code))))
+    {
+        latency::Probe::set_action(action->latency_id);
+
+        if (action->wm_command)
+        {
+            action->wm_command(cmd, with_shift);
+        }
+        else if (limiter.permit(*action->launch_limit))
+        {
+            limiter.launched(*action->launch_limit, launch(action->command_line, action->shell));
+            latency::Probe::mark(latency::Stage::completed);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void miriway::Shortcuts::advise_window_for(pid_t pid)
+{
+    limiter.advise_window_for(pid);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_SHORTCUTS_H
+#define MIRIWAY_SHORTCUTS_H
+
+#include "miriway_commands.h"
+#include "miriway_latency.h"
+#include "miriway_launch_limiter.h"
+
+#include <miral/live_config.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace miriway
+{
+using namespace miral;
+
+// Build a single index of commands from the "<key>:<commands>" shortcut settings and
+// dispatch them by (<modifiers>, <key>) (if found).
+//
+// Each `add_source()` registers one "command_..." setting. Whenever any of these settings
+// changes the complete table is rebuilt and published atomically, so the input path only
+// ever sees a consistent snapshot and finds a binding with a single hash probe.
+class Shortcuts
+{
+public:
+    using Modifiers = ShellCommands::Modifiers;
+    using Launch = std::function<pid_t(std::vector<std::string> const& command_line, bool shell)>;
+    using Prepare = std::function<void(std::vector<std::string> const& command_line)>;
+
+    // `prepare` is called for each command line as the configuration is loaded, ahead of any `launch`
+    Shortcuts(live_config::Store& store, Launch launch, Prepare prepare);
+
+    // Register "command_<option>" as a source of <modifiers> shortcuts. Launches from `shell`
+    // sources get shell privileges and take precedence over other bindings of the same key.
+    void add_source(
+        live_config::Store& store,
+        std::string const& option,
+        std::string const& description,
+        Modifiers modifiers,
+        bool shell);
+
+    bool try_command_for(Modifiers modifiers, xkb_keysym_t key_code, bool with_shift, ShellCommands* cmd);
+
+    // A process has mapped a window (so any launch of it is complete)
+    void advise_window_for(pid_t pid);
+
+private:
+    struct Action
+    {
+        ShellCommands::CmdFunctor wm_command;
+        std::vector<std::string> command_line;
+        bool shell = false;
+        latency::ActionId latency_id = 0;
+        std::shared_ptr<LaunchLimiter::Binding> launch_limit;
+    };
+
+    struct Source
+    {
+        Modifiers const modifiers;
+        bool const shell;
+        std::vector<std::pair<xkb_keysym_t, Action>> bindings;
+    };
+
+    class Table;
+
+    Launch const launch;
+    Prepare const prepare;
+    LaunchLimiter limiter;
+
+    std::mutex sources_mutex;
+    std::list<Source> sources;
+
+    // Written by the settings handlers and read on the input path
+    std::atomic<std::shared_ptr<Table const>> table;
+
+    void rebuild();
+};
+}
+
+#endif //MIRIWAY_SHORTCUTS_H
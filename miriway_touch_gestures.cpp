@@ -0,0 +1,177 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_touch_gestures.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Distance (in pixels) the fingers must travel together to count as a swipe
+float constexpr swipe_threshold = 100.0f;
+
+// Change in the spread of the fingers to count as a pinch
+float constexpr pinch_out_ratio = 1.5f;
+float constexpr pinch_in_ratio = 1.0f/pinch_out_ratio;
+}
+
+auto miriway::TouchGestures::process(MirTouchEvent const* tev) -> Result
+{
+    auto const count = mir_touch_event_point_count(tev);
+
+    if (!tracking)
+    {
+        if (count < min_fingers || count > max_fingers)
+            return {false, Gesture::none};
+
+        tracking = true;
+        recognised = false;
+        point_count = 0;
+    }
+
+    bool all_up = true;
+    for (unsigned i = 0; i != count; ++i)
+    {
+        auto const x = mir_touch_event_axis_value(tev, i, mir_touch_axis_x);
+        auto const y = mir_touch_event_axis_value(tev, i, mir_touch_axis_y);
+
+        if (auto const point = slot_for(mir_touch_event_id(tev, i), x, y))
+        {
+            point->x = x;
+            point->y = y;
+        }
+
+        if (mir_touch_event_action(tev, i) != mir_touch_action_up)
+            all_up = false;
+    }
+
+    // Let through any event releasing a point the client has. (It may also move the client's
+    // other points, and the client ignores the points it never saw go down.)
+    auto const consumed = !releases_client_point(tev);
+
+    if (all_up)
+    {
+        tracking = false;
+        return {consumed, Gesture::none};
+    }
+
+    if (recognised)
+        return {consumed, Gesture::none};
+
+    auto const gesture = recognise();
+    recognised = gesture != Gesture::none;
+    return {consumed, gesture};
+}
+
+void miriway::TouchGestures::delivered(MirTouchEvent const* tev)
+{
+    for (unsigned i = 0; i != mir_touch_event_point_count(tev); ++i)
+    {
+        auto const id = mir_touch_event_id(tev, i);
+        auto const end = client_points.begin() + client_point_count;
+        auto const found = std::find(client_points.begin(), end, id);
+
+        switch (mir_touch_event_action(tev, i))
+        {
+        case mir_touch_action_down:
+            if (found == end && client_point_count != max_points)
+                client_points[client_point_count++] = id;
+            break;
+
+        case mir_touch_action_up:
+            if (found != end)
+                *found = client_points[--client_point_count];
+            break;
+
+        default:;
+        }
+    }
+}
+
+auto miriway::TouchGestures::releases_client_point(MirTouchEvent const* tev) const -> bool
+{
+    auto const end = client_points.begin() + client_point_count;
+    for (unsigned i = 0; i != mir_touch_event_point_count(tev); ++i)
+    {
+        if (mir_touch_event_action(tev, i) == mir_touch_action_up &&
+            std::find(client_points.begin(), end, mir_touch_event_id(tev, i)) != end)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+auto miriway::TouchGestures::slot_for(MirTouchId id, float x, float y) -> Point*
+{
+    for (unsigned i = 0; i != point_count; ++i)
+    {
+        if (points[i].id == id)
+            return &points[i];
+    }
+
+    if (point_count == max_points)
+        return nullptr;
+
+    points[point_count] = Point{id, x, y, x, y};
+    return &points[point_count++];
+}
+
+auto miriway::TouchGestures::recognise() const -> Gesture
+{
+    float start_x = 0, start_y = 0, x = 0, y = 0;
+    for (unsigned i = 0; i != point_count; ++i)
+    {
+        start_x += points[i].start_x;
+        start_y += points[i].start_y;
+        x += points[i].x;
+        y += points[i].y;
+    }
+    start_x /= point_count;
+    start_y /= point_count;
+    x /= point_count;
+    y /= point_count;
+
+    auto const dx = x - start_x;
+    auto const dy = y - start_y;
+
+    if (std::abs(dy) > swipe_threshold && std::abs(dy) > 2*std::abs(dx))
+    {
+        return dy < 0 ? Gesture::swipe_up : Gesture::swipe_down;
+    }
+
+    float start_spread = 0, spread = 0;
+    for (unsigned i = 0; i != point_count; ++i)
+    {
+        start_spread += std::hypot(points[i].start_x - start_x, points[i].start_y - start_y);
+        spread += std::hypot(points[i].x - x, points[i].y - y);
+    }
+
+    if (start_spread > 0)
+    {
+        if (spread > pinch_out_ratio*start_spread)
+            return Gesture::pinch_out;
+
+        if (spread < pinch_in_ratio*start_spread)
+            return Gesture::pinch_in;
+    }
+
+    return Gesture::none;
+}
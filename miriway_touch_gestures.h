@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_TOUCH_GESTURES_H
+#define MIRIWAY_TOUCH_GESTURES_H
+
+#include <miral/toolkit_event.h>
+
+#include <array>
+
+namespace miriway
+{
+using namespace miral::toolkit;
+
+// Recognises 3 and 4 finger swipes and pinches.
+//
+// State is kept in fixed size arrays, so processing a touch event involves no allocation.
+// Touch events with fewer than 3 points are rejected immediately (unless a gesture is
+// already in progress) so that ordinary touches reach clients without delay.
+//
+// Once a gesture starts, events are only passed on to release the points the client already
+// has (so no touch is left "down"): the gesture's other points never reach the client.
+class TouchGestures
+{
+public:
+    enum class Gesture { none, swipe_up, swipe_down, pinch_in, pinch_out };
+
+    struct Result
+    {
+        bool consumed;      // The event is part of a (potential) gesture and should not reach clients
+        Gesture gesture;    // A gesture has been recognised
+    };
+
+    auto process(MirTouchEvent const* tev) -> Result;
+
+    // `tev` has been delivered to clients (so they have its points down)
+    void delivered(MirTouchEvent const* tev);
+
+private:
+    static unsigned constexpr min_fingers = 3;
+    static unsigned constexpr max_fingers = 4;
+    static unsigned constexpr max_points = 10;
+
+    struct Point
+    {
+        MirTouchId id;
+        float start_x;
+        float start_y;
+        float x;
+        float y;
+    };
+
+    std::array<Point, max_points> points;
+    unsigned point_count = 0;
+    bool tracking = false;
+    bool recognised = false;
+
+    // The points that are down as far as the client is concerned
+    std::array<MirTouchId, max_points> client_points;
+    unsigned client_point_count = 0;
+
+    auto slot_for(MirTouchId id, float x, float y) -> Point*;
+    auto releases_client_point(MirTouchEvent const* tev) const -> bool;
+    auto recognise() const -> Gesture;
+};
+}
+
+#endif //MIRIWAY_TOUCH_GESTURES_H
@@ -0,0 +1,160 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "miriway_window_mru.h"
+
+#include <algorithm>
+#include <iterator>
+
+auto miriway::WindowMru::Hash::operator()(Window const& window) const -> std::size_t
+{
+    return std::hash<std::shared_ptr<mir::scene::Surface>>{}(window);
+}
+
+void miriway::WindowMru::add(Window const& window)
+{
+    if (index.contains(window))
+        return;
+
+    auto const application = window.application();
+    auto app = app_index.find(application);
+    if (app == app_index.end())
+    {
+        app = app_index.emplace(application, apps.insert(apps.end(), App{application, {}})).first;
+    }
+
+    auto const in_app = app->second->windows.insert(app->second->windows.end(), window);
+    index.emplace(window, Entry{order.insert(order.end(), window), app->second, in_app});
+}
+
+void miriway::WindowMru::remove(Window const& window)
+{
+    if (auto const i = index.find(window); i != index.end())
+    {
+        auto const [in_order, app, in_app] = i->second;
+        order.erase(in_order);
+        app->windows.erase(in_app);
+        if (app->windows.empty())
+        {
+            app_index.erase(app->application);
+            apps.erase(app);
+        }
+        index.erase(i);
+    }
+}
+
+void miriway::WindowMru::touch(Window const& window)
+{
+    if (auto const i = index.find(window); i != index.end())
+    {
+        auto const& [in_order, app, in_app] = i->second;
+        order.splice(order.begin(), order, in_order);
+        apps.splice(apps.begin(), apps, app);
+        app->windows.splice(app->windows.begin(), app->windows, in_app);
+    }
+}
+
+auto miriway::WindowMru::contains(Window const& window) const -> bool
+{
+    return index.contains(window);
+}
+
+auto miriway::WindowMru::most_recent(std::function<bool(Window const&)> const& predicate) const -> Window
+{
+    for (auto const& window : order)
+    {
+        if (predicate(window))
+            return window;
+    }
+
+    return Window{};
+}
+
+void miriway::WindowMru::order_by_recency(std::vector<Window>& windows) const
+{
+    std::unordered_map<Window, std::size_t, Hash> position;
+    for (auto const& window : windows)
+    {
+        position.emplace(window, order.size());
+    }
+
+    std::size_t i = 0;
+    for (auto const& window : order)
+    {
+        if (auto const p = position.find(window); p != position.end())
+        {
+            p->second = i;
+        }
+        ++i;
+    }
+
+    std::stable_sort(windows.begin(), windows.end(),
+        [&](Window const& l, Window const& r) { return position[l] < position[r]; });
+}
+
+auto miriway::WindowMru::most_recent() const -> Window
+{
+    return order.empty() ? Window{} : order.front();
+}
+
+auto miriway::WindowMru::next_app(Window const& window) const -> Window
+{
+    auto const i = index.find(window);
+    if (i == index.end())
+        return most_recent();
+
+    Apps::const_iterator app = std::next(i->second.app);
+    if (app == apps.end())
+        app = apps.begin();
+
+    return app->windows.front();
+}
+
+auto miriway::WindowMru::prev_app(Window const& window) const -> Window
+{
+    auto const i = index.find(window);
+    if (i == index.end())
+        return most_recent();
+
+    Apps::const_iterator app = i->second.app;
+    if (app == apps.begin())
+        app = apps.end();
+
+    return std::prev(app)->windows.front();
+}
+
+auto miriway::WindowMru::next_window(Window const& window) const -> Window
+{
+    auto const i = index.find(window);
+    if (i == index.end())
+        return most_recent();
+
+    auto const& windows = i->second.app->windows;
+    auto next = std::next(i->second.in_app);
+    return next == windows.end() ? windows.front() : *next;
+}
+
+auto miriway::WindowMru::prev_window(Window const& window) const -> Window
+{
+    auto const i = index.find(window);
+    if (i == index.end())
+        return most_recent();
+
+    auto const& windows = i->second.app->windows;
+    return i->second.in_app == windows.begin() ? windows.back() : *std::prev(i->second.in_app);
+}
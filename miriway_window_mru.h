@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRIWAY_WINDOW_MRU_H
+#define MIRIWAY_WINDOW_MRU_H
+
+#include <miral/application.h>
+#include <miral/window.h>
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace miriway
+{
+using miral::Application;
+using miral::Window;
+
+// Application windows (across all workspaces) in most recently used order. The windows of
+// each application are also kept in that order, as are the applications themselves, for
+// switching between them.
+//
+// Maintained incrementally from the window management notifications: adding, removing and
+// bringing a window to the front are all O(1), as is stepping to the next or previous window
+// or application. So the order never has to be established by scanning the windows.
+class WindowMru
+{
+public:
+    // A new window starts as the least recently used (it becomes most recent when it gains focus)
+    void add(Window const& window);
+
+    void remove(Window const& window);
+
+    // Make `window` (and its application) the most recently used
+    void touch(Window const& window);
+
+    auto contains(Window const& window) const -> bool;
+
+    // The most recently used window satisfying `predicate` (or a null window)
+    auto most_recent(std::function<bool(Window const&)> const& predicate) const -> Window;
+
+    // Sort `windows` into most recently used order (any not known here go last)
+    void order_by_recency(std::vector<Window>& windows) const;
+
+    // The most recently used window of the application after (or before) that of `window`,
+    // wrapping around. If `window` isn't known, the most recently used window.
+    auto next_app(Window const& window) const -> Window;
+    auto prev_app(Window const& window) const -> Window;
+
+    // The window of the same application after (or before) `window`, wrapping around. If
+    // `window` isn't known, the most recently used window.
+    auto next_window(Window const& window) const -> Window;
+    auto prev_window(Window const& window) const -> Window;
+
+private:
+    struct Hash
+    {
+        auto operator()(Window const& window) const -> std::size_t;
+    };
+
+    using Order = std::list<Window>;
+
+    struct App
+    {
+        Application application;
+        Order windows;
+    };
+
+    using Apps = std::list<App>;
+
+    struct Entry
+    {
+        Order::iterator in_order;
+        Apps::iterator app;
+        Order::iterator in_app;
+    };
+
+    Order order;
+    Apps apps;
+    std::unordered_map<Window, Entry, Hash> index;
+    std::unordered_map<Application, Apps::iterator> app_index;
+
+    auto most_recent() const -> Window;
+};
+}
+
+#endif //MIRIWAY_WINDOW_MRU_H
@@ -39,6 +39,8 @@ public:
     virtual ~WorkspaceHooks() = default;
 
     virtual void on_workspace_create(std::shared_ptr<Workspace> const& wksp) = 0;
+    // `wksp` is at (0-based) `position` in the workspaces of `output` (called when either changes)
+    virtual void on_workspace_assign(std::shared_ptr<Workspace> const& wksp, Output const& output, unsigned position) = 0;
     virtual void on_workspace_activate(std::shared_ptr<Workspace> const& wksp) = 0;
     virtual void on_workspace_deactivate(std::shared_ptr<Workspace> const& wksp) = 0;
     virtual void on_workspace_destroy(std::shared_ptr<Workspace> const& wksp) = 0;
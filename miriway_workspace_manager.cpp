@@ -17,8 +17,14 @@
  */
 
 #include "miriway_workspace_manager.h"
+#include "miriway_latency.h"
 
 #include <mir/log.h>
+#include <mir/scene/surface.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
 
 using namespace mir::geometry;
 using namespace miral;
@@ -26,8 +32,7 @@ using namespace miral;
 struct miriway::WorkspaceManager::WorkspaceInfo
 {
     bool in_hidden_workspace{false};
-
-    MirWindowState old_state = mir_window_state_unknown;
+    std::optional<MirWindowState> deferred_state;
 };
 
 
@@ -39,16 +44,29 @@ miriway::WorkspaceManager::WorkspaceManager(miriway::WorkspaceHooks &hooks, cons
        {
            tools_.invoke_under_lock([this, workspace]
                 {
-                    auto const old_active= active_workspace_;
-                    if (*old_active != workspace)
+                    if (auto const i = workspace_index.find(workspace); i != workspace_index.end())
                     {
-                        active_workspace_ = std::find(workspaces.begin(), workspaces.end(), workspace);
-                        change_active_workspace(workspace, *old_active, Window{});
-                        erase_if_empty(old_active);
+                        auto& set = workspace_sets.at(i->second.output);
+                        auto const old_active = set.workspaces[set.active_index];
+                        if (old_active != workspace)
+                        {
+                            set.active_index = i->second.index;
+                            change_active_workspace(workspace, old_active, Window{});
+                            erase_if_empty(old_active);
+                        }
                     }
                 });
        });
-    append_new_workspace();
+
+    if (getenv("MIRIWAY_MEASURE_HIDDEN_CPU"))
+    {
+        cpu_meter.emplace();
+    }
+
+    // Until the outputs are known, there's a single set of workspaces
+    auto& set = workspace_sets[no_output];
+    set.id = no_output;
+    append_new_workspace(set);
 }
 
 miriway::WorkspaceManager::~WorkspaceManager()
@@ -56,20 +74,19 @@ miriway::WorkspaceManager::~WorkspaceManager()
     hooks.set_workspace_activator_callback([](auto...) {});
 }
 
+void miriway::WorkspaceManager::use_app_freezer(AppFreezer& freezer)
+{
+    app_freezer = &freezer;
+}
+
 void miriway::WorkspaceManager::workspace_begin(bool take_active)
 {
     tools_.invoke_under_lock(
         [this, take_active]
             {
-            if (active_workspace_ != workspaces.begin())
-            {
-                auto const old_workspace = active_workspace_;
-                auto const& window = take_active ? tools_.active_window() : Window{};
-                auto const& old_active = *active_workspace_;
-                auto const& new_active = *(active_workspace_ = workspaces.cbegin());
-                change_active_workspace(new_active, old_active, window);
-                erase_if_empty(old_workspace);
-            }
+            latency::UnderLock const timing;
+
+            switch_to(focused_set(), 0, take_active);
         });
 }
 
@@ -78,13 +95,10 @@ void miriway::WorkspaceManager::workspace_end(bool take_active)
     tools_.invoke_under_lock(
         [this, take_active]
             {
-            auto const old_workspace = active_workspace_;
-            auto const& window = take_active ? tools_.active_window() : Window{};
-            auto const& old_active = *active_workspace_;
-            append_new_workspace();
-            auto const& new_active = *active_workspace_;
-            change_active_workspace(new_active, old_active, window);
-            erase_if_empty(old_workspace);
+            latency::UnderLock const timing;
+
+            auto& set = focused_set();
+            switch_to(set, set.workspaces.size(), take_active);
         });
 }
 
@@ -93,14 +107,11 @@ void miriway::WorkspaceManager::workspace_up(bool take_active)
     tools_.invoke_under_lock(
         [this, take_active]
         {
-            if (active_workspace_ != workspaces.cbegin())
+            latency::UnderLock const timing;
+
+            if (auto& set = focused_set(); set.active_index != 0)
             {
-                auto const old_workspace = active_workspace_;
-                auto const& window = take_active ? tools_.active_window() : Window{};
-                auto const& old_active = *active_workspace_;
-                auto const& new_active = *--active_workspace_;
-                change_active_workspace(new_active, old_active, window);
-                erase_if_empty(old_workspace);
+                switch_to(set, set.active_index - 1, take_active);
             }
         });
 }
@@ -110,40 +121,398 @@ void miriway::WorkspaceManager::workspace_down(bool take_active)
     tools_.invoke_under_lock(
         [this, take_active]
         {
-            auto const old_workspace = active_workspace_;
-            auto const& window = take_active ? tools_.active_window() : Window{};
-            auto const& old_active = *active_workspace_;
-            if (++active_workspace_ == workspaces.cend())
+            latency::UnderLock const timing;
+
+            auto& set = focused_set();
+            switch_to(set, set.active_index + 1, take_active);
+        });
+}
+
+void miriway::WorkspaceManager::workspace_goto(int number, bool take_active)
+{
+    tools_.invoke_under_lock(
+        [this, number, take_active]
+        {
+            latency::UnderLock const timing;
+
+            if (number >= 1)
+            {
+                auto& set = focused_set();
+                switch_to(set, std::min<std::size_t>(number - 1, set.workspaces.size()), take_active);
+            }
+        });
+}
+
+void miriway::WorkspaceManager::send_to_workspace(int number)
+{
+    tools_.invoke_under_lock(
+        [this, number]
+        {
+            latency::UnderLock const timing;
+
+            if (number >= 1)
             {
-                append_new_workspace();
+                auto& set = focused_set();
+                send_to(set, std::min<std::size_t>(number - 1, set.workspaces.size()));
             }
-            auto const& new_active = *active_workspace_;
-            change_active_workspace(new_active, old_active, window);
-            erase_if_empty(old_workspace);
         });
 }
 
-void miriway::WorkspaceManager::append_new_workspace()
+void miriway::WorkspaceManager::send_to_workspace_step(int steps)
+{
+    tools_.invoke_under_lock(
+        [this, steps]
+        {
+            latency::UnderLock const timing;
+
+            auto& set = focused_set();
+            auto const target = std::clamp<std::ptrdiff_t>(
+                std::ptrdiff_t(set.active_index) + steps, 0, std::ptrdiff_t(set.workspaces.size()));
+            send_to(set, target);
+        });
+}
+
+void miriway::WorkspaceManager::switch_app(bool reverse)
+{
+    tools_.invoke_under_lock(
+        [this, reverse]
+        {
+            latency::UnderLock const timing;
+
+            switch_step(reverse ? &WindowMru::prev_app : &WindowMru::next_app);
+        });
+}
+
+void miriway::WorkspaceManager::switch_window(bool reverse)
+{
+    tools_.invoke_under_lock(
+        [this, reverse]
+        {
+            latency::UnderLock const timing;
+
+            switch_step(reverse ? &WindowMru::prev_window : &WindowMru::next_window);
+        });
+}
+
+void miriway::WorkspaceManager::switch_confirm()
+{
+    tools_.invoke_under_lock(
+        [this]
+        {
+            if (switch_origin)
+            {
+                switch_origin.reset();
+                mru.touch(switch_cursor);
+            }
+        });
+}
+
+void miriway::WorkspaceManager::switch_cancel()
+{
+    tools_.invoke_under_lock(
+        [this]
+        {
+            if (switch_origin)
+            {
+                if (mru.contains(*switch_origin))
+                {
+                    switch_select(*switch_origin);
+                }
+                switch_origin.reset();
+            }
+        });
+}
+
+void miriway::WorkspaceManager::switch_step(Window (WindowMru::*step)(Window const&) const)
+{
+    if (!switch_origin)
+    {
+        switch_origin = tools_.active_window();
+        switch_cursor = tools_.active_window();
+    }
+
+    switch_select((mru.*step)(switch_cursor));
+}
+
+void miriway::WorkspaceManager::switch_select(Window const& window)
+{
+    if (!window)
+        return;
+
+    switch_cursor = window;
+    switch_selecting = true;
+    if (in_hidden_workspace(tools_.info_for(window)))
+    {
+        activate_workspace_containing(window);
+    }
+    tools_.select_active_window(window);
+    tools_.raise_tree(window);
+    switch_selecting = false;
+}
+
+void miriway::WorkspaceManager::send_to(WorkspaceSet& set, std::size_t index)
 {
-    workspaces.push_back(tools_.create_workspace());
-    active_workspace_ = --workspaces.cend();
-    hooks.on_workspace_create(*active_workspace_);
-    hooks.on_workspace_activate(*active_workspace_);
+    if (index == set.active_index)
+        return;
+
+    // Only application windows belong to a workspace (always-on-top windows are on all of them)
+    auto window = tools_.active_window();
+    if (!window || tools_.info_for(window).depth_layer() != mir_depth_layer_application)
+        return;
+
+    // Send the whole tree (e.g. an app with a dialog active)
+    while (auto const parent = tools_.info_for(window).parent())
+    {
+        window = parent;
+    }
+
+    auto const target = index < set.workspaces.size() ? set.workspaces[index] : add_workspace(set);
+
+    // Moving the tree hides just its windows (and, as the active window hides, focus moves on)
+    tools_.remove_tree_from_workspace(window, set.workspaces[set.active_index]);
+    tools_.add_tree_to_workspace(window, target);
+}
+
+void miriway::WorkspaceManager::switch_to(WorkspaceSet& set, std::size_t index, bool take_active)
+{
+    if (index == set.active_index)
+        return;
+
+    auto const old_active = set.workspaces[set.active_index];
+    auto const window = take_active ? tools_.active_window() : Window{};
+    if (index < set.workspaces.size())
+    {
+        set.active_index = index;
+    }
+    else
+    {
+        append_new_workspace(set);
+    }
+
+    // A copy: the transition must not depend on the workspace vector staying unchanged
+    auto const new_active = set.workspaces[set.active_index];
+    change_active_workspace(new_active, old_active, window);
+    erase_if_empty(old_active);
 }
 
-void miriway::WorkspaceManager::erase_if_empty(workspace_list::const_iterator const& old_workspace)
+auto miriway::WorkspaceManager::focused_set() -> WorkspaceSet&
 {
-    bool empty = true;
-    tools_.for_each_window_in_workspace(*old_workspace, [&](auto ww)
+    // The "active output" may be a display area spanning several outputs, so it needn't match
+    // an output's extents: use the output containing its centre
+    auto const active_output = tools_.active_output();
+    auto const centre = active_output.top_left +
+        Displacement{as_delta(active_output.size.width/2), as_delta(active_output.size.height/2)};
+    if (auto const set = set_at(centre))
+        return *set;
+
+    // Before the outputs are known there's only one set
+    return workspace_sets.begin()->second;
+}
+
+auto miriway::WorkspaceManager::set_at(Point point) -> WorkspaceSet*
+{
+    for (auto& [_, set] : workspace_sets)
+    {
+        if (set.output && set.output->extents().contains(point))
+            return &set;
+    }
+
+    return nullptr;
+}
+
+auto miriway::WorkspaceManager::add_workspace(WorkspaceSet& set) -> std::shared_ptr<Workspace>
+{
+    auto const workspace = tools_.create_workspace();
+    workspace_index[workspace] = {set.id, set.workspaces.size(), 0};
+    set.workspaces.push_back(workspace);
+    hooks.on_workspace_create(workspace);
+    if (set.output)
+    {
+        hooks.on_workspace_assign(workspace, *set.output, set.workspaces.size() - 1);
+    }
+    return workspace;
+}
+
+void miriway::WorkspaceManager::append_new_workspace(WorkspaceSet& set)
+{
+    auto const workspace = add_workspace(set);
+    set.active_index = set.workspaces.size() - 1;
+    hooks.on_workspace_activate(workspace);
+}
+
+void miriway::WorkspaceManager::reindex(WorkspaceSet const& set, std::size_t from)
+{
+    for (auto i = from; i != set.workspaces.size(); ++i)
+    {
+        auto& entry = workspace_index[set.workspaces[i]];
+        entry.output = set.id;
+        entry.index = i;
+        if (set.output)
         {
-            if (is_application(tools_.info_for(ww).depth_layer()))
-                empty = false;
+            hooks.on_workspace_assign(set.workspaces[i], *set.output, i);
+        }
+    }
+}
+
+void miriway::WorkspaceManager::erase_if_empty(std::shared_ptr<Workspace> const& workspace)
+{
+    // The workspace may already have been reclaimed (when its last window left)
+    auto const entry = workspace_index.find(workspace);
+    if (entry == workspace_index.end() || entry->second.app_windows != 0)
+        return;
+
+    auto& set = workspace_sets.at(entry->second.output);
+    auto const index = entry->second.index;
+
+    // An output always has an active workspace
+    if (index == set.active_index)
+        return;
+
+    set.workspaces.erase(set.workspaces.begin() + index);
+    workspace_index.erase(entry);
+    reindex(set, index);
+    if (set.active_index > index)
+    {
+        --set.active_index;
+    }
+    hooks.on_workspace_destroy(workspace);
+}
+
+void miriway::WorkspaceManager::advise_output_create(Output const& output)
+{
+    auto const id = output.id();
+    if (workspace_sets.contains(id))
+        return;
+
+    // The first output adopts the workspaces created before any output was known
+    if (auto orphans = workspace_sets.extract(no_output))
+    {
+        orphans.key() = id;
+        auto& set = workspace_sets.insert(std::move(orphans)).position->second;
+        set.id = id;
+        set.output = output;
+        reindex(set, 0);
+        return;
+    }
+
+    auto& set = workspace_sets[id];
+    set.id = id;
+    set.output = output;
+    append_new_workspace(set);
+}
+
+void miriway::WorkspaceManager::advise_output_update(Output const& updated, Output const& original)
+{
+    if (auto const i = workspace_sets.find(original.id()); i != workspace_sets.end())
+    {
+        i->second.output = updated;
+    }
+}
+
+void miriway::WorkspaceManager::advise_output_delete(Output const& output)
+{
+    auto removed = workspace_sets.extract(output.id());
+    if (!removed)
+        return;
+
+    auto& from = removed.mapped();
+    auto const from_active = from.workspaces[from.active_index];
+
+    if (workspace_sets.empty())
+    {
+        // Keep the workspaces until there's an output again
+        removed.key() = no_output;
+        from.id = no_output;
+        from.output.reset();
+        reindex(workspace_sets.insert(std::move(removed)).position->second, 0);
+        return;
+    }
+
+    // The remaining workspaces join another output's set: they were hidden, and stay hidden
+    auto& to = workspace_sets.begin()->second;
+    auto const to_active = to.workspaces[to.active_index];
+    auto const first = to.workspaces.size();
+    for (auto const& workspace : from.workspaces)
+    {
+        if (workspace != from_active)
+            to.workspaces.push_back(workspace);
+    }
+    reindex(to, first);
+
+    // The windows that were visible on the output stay visible: move them to the active workspace
+    std::vector<Window> visible;
+    tools_.for_each_window_in_workspace(from_active, [&](Window const& ww)
+        {
+            if (!tools_.info_for(ww).parent())
+                visible.push_back(ww);
         });
-    if (empty)
+
+    // (Removing the windows doesn't reclaim `from_active` as it is no longer in the index)
+    workspace_index.erase(from_active);
+    for (auto const& ww : visible)
     {
-        workspace_to_active.erase(*old_workspace);
-        workspaces.erase(old_workspace);
-        hooks.on_workspace_destroy(*old_workspace);
+        tools_.remove_tree_from_workspace(ww, from_active);
+        tools_.add_tree_to_workspace(ww, to_active);
+    }
+    hooks.on_workspace_deactivate(from_active);
+    hooks.on_workspace_destroy(from_active);
+}
+
+void miriway::WorkspaceManager::advise_move_to(WindowInfo const& window_info, Point top_left)
+{
+    if (window_info.parent() || !is_application(window_info.depth_layer()) || in_hidden_workspace(window_info))
+        return;
+
+    // A window moved onto another output joins that output's active workspace
+    auto const size = window_info.window().size();
+    auto const target = set_at(top_left + Displacement{as_delta(size.width/2), as_delta(size.height/2)});
+    if (!target)
+        return;
+
+    std::shared_ptr<Workspace> from;
+    tools_.for_each_workspace_containing(window_info.window(), [&](std::shared_ptr<Workspace> const& workspace)
+        {
+            if (auto const entry = workspace_index.find(workspace);
+                entry != workspace_index.end() && entry->second.output != target->id)
+            {
+                from = workspace;
+            }
+        });
+
+    if (from)
+    {
+        tools_.remove_tree_from_workspace(window_info.window(), from);
+        tools_.add_tree_to_workspace(window_info.window(), target->workspaces[target->active_index]);
+    }
+}
+
+auto miriway::WorkspaceManager::is_active(std::shared_ptr<Workspace> const& workspace) const -> bool
+{
+    if (auto const entry = workspace_index.find(workspace); entry != workspace_index.end())
+    {
+        return workspace_sets.at(entry->second.output).active_index == entry->second.index;
+    }
+
+    return false;
+}
+
+void miriway::WorkspaceManager::defer_state_change(WindowInfo const& window_info, WindowSpecification& modifications)
+{
+    if (!modifications.state() || !in_hidden_workspace(window_info))
+        return;
+
+    auto& workspace_info = workspace_info_for(window_info);
+    switch (modifications.state().value())
+    {
+    case mir_window_state_hidden:
+    case mir_window_state_minimized:
+        // miral hides the surface for these, so apply them now (replacing any earlier request)
+        workspace_info.deferred_state.reset();
+        break;
+
+    default:
+        workspace_info.deferred_state = modifications.state().value();
+        reset_optional(modifications.state());
     }
 }
 
@@ -154,12 +523,24 @@ void miriway::WorkspaceManager::apply_workspace_hidden_to(Window const& window)
     if (!workspace_info.in_hidden_workspace)
     {
         workspace_info.in_hidden_workspace = true;
-        workspace_info.old_state = window_info.state();
 
-        WindowSpecification modifications;
-        modifications.state() = mir_window_state_hidden;
-        tools_.place_and_size_for_state(modifications, window_info);
-        tools_.modify_window(window_info.window(), modifications);
+        hide_surface(window);
+
+        if (cpu_meter)
+        {
+            cpu_meter->hidden(pid_of(window.application()));
+        }
+
+        if (app_freezer)
+        {
+            app_freezer->window_hidden(window);
+        }
+
+        // Unlike a state change, hiding the surface doesn't move focus
+        if (window == tools_.active_window())
+        {
+            tools_.select_active_window(most_recent_in(active_workspace()));
+        }
     }
 }
 
@@ -170,10 +551,61 @@ void miriway::WorkspaceManager::apply_workspace_visible_to(Window const& window)
     if (workspace_info.in_hidden_workspace)
     {
         workspace_info.in_hidden_workspace = false;
-        WindowSpecification modifications;
-        modifications.state() = workspace_info.old_state;
-        tools_.place_and_size_for_state(modifications, window_info);
-        tools_.modify_window(window_info.window(), modifications);
+
+        if (cpu_meter)
+        {
+            cpu_meter->shown(pid_of(window.application()));
+        }
+
+        // Thaw a frozen app before it is shown
+        if (app_freezer)
+        {
+            app_freezer->window_shown(window);
+        }
+
+        // Apply a state change the client asked for while the window was hidden
+        if (auto const state = std::exchange(workspace_info.deferred_state, std::nullopt))
+        {
+            WindowSpecification modifications;
+            modifications.state() = *state;
+            tools_.place_and_size_for_state(modifications, window_info);
+            tools_.modify_window(window, modifications);
+        }
+
+        // A window the client (or user) has hidden or minimized stays that way
+        switch (window_info.state())
+        {
+        case mir_window_state_hidden:
+        case mir_window_state_minimized:
+            break;
+
+        default:
+            show_surface(window);
+        }
+    }
+}
+
+void miriway::WorkspaceManager::hide_surface(Window const& window)
+{
+    // Hide the surface in the compositor (excluding it from rendering and input) without
+    // changing the window state: the client isn't told, so it keeps its size and buffers.
+    // It is also marked occluded (as the compositor marks a surface it finds entirely covered),
+    // so that it is throttled as a covered surface is, rather than drawing frames nobody sees.
+    if (auto const surface = std::shared_ptr<mir::scene::Surface>(window))
+    {
+        surface->hide();
+        surface->configure(mir_window_attrib_visibility, mir_window_visibility_occluded);
+    }
+}
+
+void miriway::WorkspaceManager::show_surface(Window const& window)
+{
+    // The compositor only reports changes of visibility, and it didn't see this one (as the
+    // surface wasn't being composited): so mark it exposed here
+    if (auto const surface = std::shared_ptr<mir::scene::Surface>(window))
+    {
+        surface->configure(mir_window_attrib_visibility, mir_window_visibility_exposed);
+        surface->show();
     }
 }
 
@@ -187,63 +619,104 @@ void miriway::WorkspaceManager::change_active_workspace(
     hooks.on_workspace_activate(new_active);
 
     auto const old_active_window = tools_.active_window();
-    auto const old_active_window_shell = old_active_window &&
-        !is_application(tools_.info_for(old_active_window).depth_layer());
 
-    if (!old_active_window || old_active_window_shell)
+    tools_.remove_tree_from_workspace(window, old_active);
+    tools_.add_tree_to_workspace(window, new_active);
+
+    // Unless a window is coming with us, restore the window that will have focus before
+    // anything else changes, so it is first to present (and focused before the old one hides)
+    if (!window)
     {
-        // If there's no active window, the first shown grabs focus: get the right one
-        if (auto const ww = workspace_to_active[new_active])
+        if (auto const ww = most_recent_in(new_active))
         {
-            tools_.for_each_workspace_containing(ww, [&](std::shared_ptr<Workspace> const& ws)
-            {
-                if (ws == new_active)
-                {
-                    apply_workspace_visible_to(ww);
-                }
-            });
-
-            // If focus was on a shell window, put it on an app
-            if (old_active_window_shell)
-                tools_.select_active_window(ww);
+            apply_workspace_visible_to(ww);
+            tools_.select_active_window(ww);
         }
     }
 
-    tools_.remove_tree_from_workspace(window, old_active);
-    tools_.add_tree_to_workspace(window, new_active);
+    // Collect the windows whose visibility changes, then apply the changes in a single pass.
+    // (So the changes aren't interleaved with walking the workspaces and looking up windows.)
+    showing.clear();
+    hiding.clear();
 
     tools_.for_each_window_in_workspace(new_active, [&](Window const& ww)
     {
-        if (is_application(tools_.info_for(ww).depth_layer()))
+        auto const& info = tools_.info_for(ww);
+        if (is_application(info.depth_layer()) && workspace_info_for(info).in_hidden_workspace)
         {
-            apply_workspace_visible_to(ww);
+            showing.push_back(ww);
         }
     });
 
     bool hide_old_active = false;
     tools_.for_each_window_in_workspace(old_active, [&](Window const& ww)
     {
-        if (is_application(tools_.info_for(ww).depth_layer()))
+        auto const& info = tools_.info_for(ww);
+        if (is_application(info.depth_layer()) && !workspace_info_for(info).in_hidden_workspace)
         {
             if (ww == old_active_window)
             {
-                // If we hide the active window focus will shift: do that last
+                // Hiding the active window moves focus: do that last
                 hide_old_active = true;
                 return;
             }
 
-            apply_workspace_hidden_to(ww);
-            return;
+            hiding.push_back(ww);
         }
     });
 
     if (hide_old_active)
     {
-        apply_workspace_hidden_to(old_active_window);
+        hiding.push_back(old_active_window);
+    }
+
+    // Restore the rest most recently used first (they're likely to be stacked highest) and defer
+    // any window entirely covered by one restored before it
+    mru.order_by_recency(showing);
+    occluded.clear();
+    for (auto i = showing.begin(); i != showing.end();)
+    {
+        auto const extents = extents_of(*i);
+        if (std::any_of(showing.begin(), i, [&](Window const& above) { return extents_of(above).contains(extents); }))
+        {
+            occluded.push_back(*i);
+            i = showing.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    showing.insert(showing.end(), occluded.begin(), occluded.end());
 
-        // Remember the old active_window when we switch away
-        workspace_to_active[old_active] = old_active_window;
+    for (auto const& ww : showing)
+    {
+        apply_workspace_visible_to(ww);
     }
+
+    for (auto const& ww : hiding)
+    {
+        apply_workspace_hidden_to(ww);
+    }
+}
+
+auto miriway::WorkspaceManager::extents_of(Window const& window) -> Rectangle
+{
+    return {window.top_left(), window.size()};
+}
+
+auto miriway::WorkspaceManager::most_recent_in(std::shared_ptr<Workspace> const& workspace) -> Window
+{
+    return mru.most_recent([&](Window const& window)
+        {
+            bool found = false;
+            tools_.for_each_workspace_containing(window, [&](std::shared_ptr<Workspace> const& ws)
+                {
+                    if (ws == workspace)
+                        found = true;
+                });
+            return found;
+        });
 }
 
 void miriway::WorkspaceManager::activate_workspace_containing(Window const& window)
@@ -251,9 +724,13 @@ void miriway::WorkspaceManager::activate_workspace_containing(Window const& wind
     tools_.for_each_workspace_containing(window,
         [this](std::shared_ptr<Workspace> const& workspace)
         {
-            auto const old_active = active_workspace_;
-            active_workspace_ = find(workspaces.cbegin(), workspaces.cend(), workspace);
-            change_active_workspace(workspace, *old_active, Window{});
+            if (auto const i = workspace_index.find(workspace); i != workspace_index.end())
+            {
+                auto& set = workspace_sets.at(i->second.output);
+                auto const old_active = set.workspaces[set.active_index];
+                set.active_index = i->second.index;
+                change_active_workspace(workspace, old_active, Window{});
+            }
         });
 }
 
@@ -263,9 +740,16 @@ void miriway::WorkspaceManager::advise_adding_to_workspace(std::shared_ptr<Works
     if (windows.empty())
         return;
 
+    auto const entry = workspace_index.find(workspace);
+
     for (auto const& window : windows)
     {
-        if (workspace == *active_workspace_)
+        if (entry != workspace_index.end() && is_application(tools_.info_for(window).depth_layer()))
+        {
+            ++entry->second.app_windows;
+        }
+
+        if (is_active(workspace))
         {
             apply_workspace_visible_to(window);
         }
@@ -276,9 +760,68 @@ void miriway::WorkspaceManager::advise_adding_to_workspace(std::shared_ptr<Works
     }
 }
 
-auto miriway::WorkspaceManager::active_workspace() const -> std::shared_ptr<Workspace>
+void miriway::WorkspaceManager::advise_removing_from_workspace(std::shared_ptr<Workspace> const& workspace,
+                                                               std::vector<Window> const& windows)
+{
+    auto const entry = workspace_index.find(workspace);
+    if (entry == workspace_index.end())
+        return;
+
+    for (auto const& window : windows)
+    {
+        if (is_application(tools_.info_for(window).depth_layer()))
+        {
+            --entry->second.app_windows;
+        }
+    }
+
+    // Reclaim a hidden workspace once its last window has left (or closed). Not here, as
+    // this is called part way through operations that still reference the workspace.
+    if (entry->second.app_windows == 0)
+    {
+        emptied.push_back(workspace);
+    }
+}
+
+void miriway::WorkspaceManager::advise_depth_layer_change(WindowInfo const& window_info, MirDepthLayer old_layer)
+{
+    auto const was_application = is_application(old_layer);
+    if (was_application == is_application(window_info.depth_layer()))
+        return;
+
+    if (was_application)
+    {
+        mru.remove(window_info.window());
+    }
+    else
+    {
+        mru.add(window_info.window());
+    }
+
+    tools_.for_each_workspace_containing(window_info.window(),
+        [this, delta = was_application ? -1 : +1](std::shared_ptr<Workspace> const& workspace)
+        {
+            if (auto const entry = workspace_index.find(workspace); entry != workspace_index.end())
+            {
+                entry->second.app_windows += delta;
+            }
+        });
+}
+
+void miriway::WorkspaceManager::advise_end()
+{
+    // (Reclaiming a workspace doesn't add to `emptied`, so iterating is safe)
+    for (auto const& workspace : emptied)
+    {
+        erase_if_empty(workspace);
+    }
+    emptied.clear();
+}
+
+auto miriway::WorkspaceManager::active_workspace() -> std::shared_ptr<Workspace>
 {
-    return *active_workspace_;
+    auto const& set = focused_set();
+    return set.workspaces[set.active_index];
 }
 
 bool miriway::WorkspaceManager::is_application(MirDepthLayer layer)
@@ -303,6 +846,11 @@ bool miriway::WorkspaceManager::in_hidden_workspace(WindowInfo const& info) cons
 
 void miriway::WorkspaceManager::advise_new_window(WindowInfo const& window_info)
 {
+    if (app_freezer)
+    {
+        app_freezer->window_added(window_info.window());
+    }
+
     if (auto const& parent = window_info.parent())
     {
         if (workspace_info_for(tools_.info_for(parent)).in_hidden_workspace)
@@ -310,7 +858,57 @@ void miriway::WorkspaceManager::advise_new_window(WindowInfo const& window_info)
     }
     else
     {
-        tools_.add_tree_to_workspace(window_info.window(), active_workspace());
+        // Add the window to the active workspace of the output it is on
+        auto const window = window_info.window();
+        auto const size = window.size();
+        auto const on_set = set_at(window.top_left() + Displacement{as_delta(size.width/2), as_delta(size.height/2)});
+        auto const& set = on_set ? *on_set : focused_set();
+        tools_.add_tree_to_workspace(window, set.workspaces[set.active_index]);
+    }
+
+    if (is_application(window_info.depth_layer()))
+    {
+        mru.add(window_info.window());
+    }
+}
+
+void miriway::WorkspaceManager::advise_delete_window(WindowInfo const& window_info)
+{
+    if (cpu_meter && in_hidden_workspace(window_info))
+    {
+        cpu_meter->shown(pid_of(window_info.window().application()));
+    }
+
+    if (app_freezer)
+    {
+        app_freezer->window_removed(window_info.window());
+    }
+
+    mru.remove(window_info.window());
+
+    if (window_info.window() == switch_cursor)
+    {
+        switch_cursor = Window{};
+    }
+}
+
+void miriway::WorkspaceManager::advise_focus_gained(WindowInfo const& window_info)
+{
+    // Focus moved by anything but the switch itself ends it
+    if (switch_origin && !switch_selecting && window_info.window() != switch_cursor)
+    {
+        switch_origin.reset();
+    }
+
+    if (app_freezer)
+    {
+        app_freezer->window_focused(window_info.window());
+    }
+
+    // While switching, the order is held (so each step moves on)
+    if (!switch_origin)
+    {
+        mru.touch(window_info.window());
     }
 }
 
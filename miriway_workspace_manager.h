@@ -19,13 +19,19 @@
 #ifndef MIRIWAY_WORKSPACE_MANAGER_H_
 #define MIRIWAY_WORKSPACE_MANAGER_H_
 
+#include "miriway_app_freezer.h"
+#include "miriway_cpu_meter.h"
+#include "miriway_window_mru.h"
 #include "miriway_workspace_hooks.h"
 
+#include <miral/output.h>
 #include <miral/window_management_policy.h>
 #include <miral/window_manager_tools.h>
 
-#include <list>
 #include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace miral { class Workspace; }
 
@@ -48,12 +54,15 @@ template<typename Optional> void reset_optional(Optional& opt)
 
 namespace miriway
 {
+using miral::Output;
 using miral::Window;
 using miral::WindowInfo;
 using miral::WindowManagerTools;
 using miral::WindowSpecification;
 using miral::Workspace;
 
+// Each output has its own set of workspaces, with its own active workspace. Workspace
+// commands act on the output with focus (so a switch only touches the windows on it).
 class WorkspaceManager
 {
 public:
@@ -61,6 +70,9 @@ public:
     WorkspaceManager(WorkspaceHooks& hooks, WindowManagerTools const& tools);
     virtual ~WorkspaceManager();
 
+    // Track application windows so `freezer` can freeze apps that are only on hidden workspaces
+    void use_app_freezer(AppFreezer& freezer);
+
     void workspace_begin(bool take_active);
 
     void workspace_end(bool take_active);
@@ -69,6 +81,29 @@ public:
 
     void workspace_down(bool take_active);
 
+    // Go directly to the `number`th (1-based) workspace, or a new one after the last
+    void workspace_goto(int number, bool take_active);
+
+    // Send the active window to the `number`th (1-based) workspace (or a new one after the last)
+    // without switching to it
+    void send_to_workspace(int number);
+
+    // Send the active window `steps` workspaces down (or up, if negative) without switching
+    void send_to_workspace_step(int steps);
+
+    // Alt+Tab style switching through the application windows (on all workspaces) in most
+    // recently used order: step to the next (or, with `reverse`, previous) application or window
+    // of the current application. The order is held while switching, so each step moves on,
+    // and updated when the switch is confirmed. Cancelling returns to where the switch began.
+    void switch_app(bool reverse);
+    void switch_window(bool reverse);
+    void switch_confirm();
+    void switch_cancel();
+
+    // miral shows a window as it applies a (not hidden) state, so a state change requested for
+    // a window in a hidden workspace is taken from `modifications` and applied when it is shown
+    void defer_state_change(WindowInfo const& window_info, WindowSpecification& modifications);
+
     void apply_workspace_hidden_to(Window const& window);
 
     void apply_workspace_visible_to(Window const& window);
@@ -81,10 +116,31 @@ public:
 
     void advise_new_window(const WindowInfo &window_info);
 
+    void advise_delete_window(const WindowInfo &window_info);
+
+    void advise_focus_gained(const WindowInfo &window_info);
+
     void advise_adding_to_workspace(std::shared_ptr<Workspace> const& workspace,
                                     std::vector<Window> const& windows);
 
-    auto active_workspace() const -> std::shared_ptr<Workspace>;
+    void advise_removing_from_workspace(std::shared_ptr<Workspace> const& workspace,
+                                        std::vector<Window> const& windows);
+
+    void advise_depth_layer_change(WindowInfo const& window_info, MirDepthLayer old_layer);
+
+    // The end of an operation under the window management lock: reclaim emptied workspaces
+    void advise_end();
+
+    void advise_output_create(Output const& output);
+
+    void advise_output_update(Output const& updated, Output const& original);
+
+    void advise_output_delete(Output const& output);
+
+    void advise_move_to(WindowInfo const& window_info, mir::geometry::Point top_left);
+
+    // The active workspace on the output with focus
+    auto active_workspace() -> std::shared_ptr<Workspace>;
 
     bool in_hidden_workspace(WindowInfo const& info) const;
 
@@ -105,14 +161,79 @@ private:
     WorkspaceHooks& hooks;
     WindowManagerTools tools_;
 
-    using workspace_list = std::list<std::shared_ptr<Workspace>>;
+    using OutputId = int;
+    static OutputId constexpr no_output = -1;   // For the workspaces created before any output is known
+
+    // An output's workspaces in order, and which of them is active
+    struct WorkspaceSet
+    {
+        OutputId id = no_output;
+        std::optional<Output> output;
+        std::vector<std::shared_ptr<Workspace>> workspaces;
+        std::size_t active_index = 0;
+    };
+
+    // Where to find a workspace, and how many application windows it holds
+    struct WorkspaceEntry
+    {
+        OutputId output;
+        std::size_t index;
+        int app_windows;
+    };
+
+    // An index so a workspace can be found without a search. Workspaces are only erased
+    // when they are empty and not active (or their output goes), so the index is updated then.
+    std::map<OutputId, WorkspaceSet> workspace_sets;
+    std::unordered_map<std::shared_ptr<Workspace>, WorkspaceEntry> workspace_index;
+    WindowMru mru;
+
+    // The active window when the current switch began (unset when not switching), the window
+    // the switch has reached, and whether the switch is what's changing focus
+    std::optional<Window> switch_origin;
+    Window switch_cursor;
+    bool switch_selecting = false;
+
+    // Set by MIRIWAY_MEASURE_HIDDEN_CPU
+    std::optional<CpuMeter> cpu_meter;
+
+    AppFreezer* app_freezer = nullptr;
+
+    // The windows to show and hide in a workspace transition (kept to reuse their storage)
+    std::vector<Window> showing;
+    std::vector<Window> hiding;
+    std::vector<Window> occluded;
+
+    // Workspaces whose last window has left. They are only reclaimed in `advise_end()`, once
+    // the operation is complete, so nothing is erased while the operation references it.
+    std::vector<std::shared_ptr<Workspace>> emptied;
+
+    static void hide_surface(Window const& window);
+    static void show_surface(Window const& window);
+
+    static auto extents_of(Window const& window) -> mir::geometry::Rectangle;
+
+    auto most_recent_in(std::shared_ptr<Workspace> const& workspace) -> Window;
 
-    workspace_list workspaces;
-    workspace_list::const_iterator active_workspace_;
-    std::map<std::shared_ptr<miral::Workspace>, miral::Window> workspace_to_active;
+    // Begin a switch (if not switching already), and focus `step(cursor)`
+    void switch_step(Window (WindowMru::*step)(Window const&) const);
+    void switch_select(Window const& window);
 
-    void append_new_workspace();
-    void erase_if_empty(workspace_list::const_iterator const& old_workspace);
+    // Activate the workspace at `index` (a new workspace if `index` is past the end) in one transition
+    void switch_to(WorkspaceSet& set, std::size_t index, bool take_active);
+
+    // The set for the output with focus, and that for the output containing `point` (if any)
+    auto focused_set() -> WorkspaceSet&;
+    auto set_at(mir::geometry::Point point) -> WorkspaceSet*;
+
+    auto is_active(std::shared_ptr<Workspace> const& workspace) const -> bool;
+
+    void send_to(WorkspaceSet& set, std::size_t index);
+
+    auto add_workspace(WorkspaceSet& set) -> std::shared_ptr<Workspace>;
+    void append_new_workspace(WorkspaceSet& set);
+    // Update the index (and tell the hooks) for the workspaces in `set` from `from` on
+    void reindex(WorkspaceSet const& set, std::size_t from);
+    void erase_if_empty(std::shared_ptr<Workspace> const& workspace);
 };
 
 // Template class to hook WorkspaceManager into a window management strategy
@@ -138,6 +259,18 @@ protected:
         WorkspaceManager::advise_new_window(window_info);
     }
 
+    void advise_delete_window(const WindowInfo &window_info) override
+    {
+        WMStrategy::advise_delete_window(window_info);
+        WorkspaceManager::advise_delete_window(window_info);
+    }
+
+    void advise_focus_gained(const WindowInfo &window_info) override
+    {
+        WMStrategy::advise_focus_gained(window_info);
+        WorkspaceManager::advise_focus_gained(window_info);
+    }
+
     void advise_adding_to_workspace(std::shared_ptr<Workspace> const& workspace,
                                     std::vector<Window> const& windows) override
     {
@@ -145,17 +278,25 @@ protected:
         WorkspaceManager::advise_adding_to_workspace(workspace, windows);
     }
 
+    void advise_removing_from_workspace(std::shared_ptr<Workspace> const& workspace,
+                                        std::vector<Window> const& windows) override
+    {
+        WMStrategy::advise_removing_from_workspace(workspace, windows);
+        WorkspaceManager::advise_removing_from_workspace(workspace, windows);
+    }
+
     void handle_modify_window(WindowInfo& window_info, WindowSpecification const& modifications) override
     {
         auto mods = modifications;
+        defer_state_change(window_info, mods);
 
-        if (in_hidden_workspace(window_info))
+        auto const old_layer = window_info.depth_layer();
+        WMStrategy::handle_modify_window(window_info, mods);
+
+        if (window_info.depth_layer() != old_layer)
         {
-            reset_optional(mods.state());       // Don't allow state changes in hidden workspaces
-            reset_optional(mods.size());        // Don't allow size changes in hidden workspaces
+            advise_depth_layer_change(window_info, old_layer);
         }
-
-        WMStrategy::handle_modify_window(window_info, mods);
     }
 
     void handle_raise_window(WindowInfo& window_info) override
@@ -167,14 +308,34 @@ protected:
         WMStrategy::handle_raise_window(window_info);
     }
 
+    void advise_move_to(WindowInfo const& window_info, mir::geometry::Point top_left) override
+    {
+        WMStrategy::advise_move_to(window_info, top_left);
+        WorkspaceManager::advise_move_to(window_info, top_left);
+    }
+
+    void advise_end() override
+    {
+        WorkspaceManager::advise_end();
+        WMStrategy::advise_end();
+    }
+
     virtual void advise_output_create(miral::Output const& output) override
     {
         WMHooks::on_output_create(output);
+        WorkspaceManager::advise_output_create(output);
         WMStrategy::advise_output_create(output);
     }
 
+    virtual void advise_output_update(miral::Output const& updated, miral::Output const& original) override
+    {
+        WorkspaceManager::advise_output_update(updated, original);
+        WMStrategy::advise_output_update(updated, original);
+    }
+
     virtual void advise_output_delete(miral::Output const& output) override
     {
+        WorkspaceManager::advise_output_delete(output);
         WMHooks::on_output_destroy(output);
         WMStrategy::advise_output_delete(output);
     }
@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2025 Octopull Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+// Reloads the shortcut settings in a loop while other threads look up shortcuts (as the
+// input path does). A lookup must always see a complete table: a key bound in every
+// configuration is always found, and nothing crashes or stalls.
+//
+// This only covers races between swapping the table and looking up a binding. The store is
+// a fake that keeps just the "command_..." handler, and the launch is a stub that starts
+// nothing (and returns pid 0), so neither child control nor real launch limiting is exercised.
+
+#include "miriway_shortcuts.h"
+
+#include <xkbcommon/xkbcommon.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace miral;
+
+namespace
+{
+// Captures the "command_..." handler so the test can "reload" it. (Other settings are ignored.)
+class ReloadingStore : public live_config::Store
+{
+public:
+    HandleStrings commands;
+
+    void add_strings_attribute(live_config::Key const&, std::string_view, HandleStrings handler) override
+    {
+        commands = std::move(handler);
+    }
+
+    void add_int_attribute(live_config::Key const&, std::string_view, HandleInt) override {}
+    void add_ints_attribute(live_config::Key const&, std::string_view, HandleInts) override {}
+    void add_bool_attribute(live_config::Key const&, std::string_view, HandleBool) override {}
+    void add_float_attribute(live_config::Key const&, std::string_view, HandleFloat) override {}
+    void add_floats_attribute(live_config::Key const&, std::string_view, HandleFloats) override {}
+    void add_string_attribute(live_config::Key const&, std::string_view, HandleString) override {}
+    void add_int_attribute(live_config::Key const&, std::string_view, int, HandleInt) override {}
+    void add_ints_attribute(live_config::Key const&, std::string_view, std::span<int const>, HandleInts) override {}
+    void add_bool_attribute(live_config::Key const&, std::string_view, bool, HandleBool) override {}
+    void add_float_attribute(live_config::Key const&, std::string_view, float, HandleFloat) override {}
+    void add_floats_attribute(live_config::Key const&, std::string_view, std::span<float const>, HandleFloats) override {}
+    void add_string_attribute(live_config::Key const&, std::string_view, std::string_view, HandleString) override {}
+    void add_strings_attribute(live_config::Key const&, std::string_view, std::span<std::string const>, HandleStrings) override {}
+    void on_done(HandleDone) override {}
+};
+
+auto constexpr run_time = std::chrono::seconds{2};
+unsigned constexpr lookup_threads = 4;
+}
+
+int main()
+{
+    ReloadingStore store;
+    miriway::Shortcuts shortcuts{
+        store,
+        [](std::vector<std::string> const&, bool) { return pid_t{0}; },
+        [](std::vector<std::string> const&) {}};
+
+    shortcuts.add_source(store, "meta", "meta shortcuts", miriway::Shortcuts::Modifiers::meta, false);
+
+    // "t" is bound in both configurations, "a" and "b" in one each
+    std::vector<std::string> const configurations[] = {
+        {"t:true", "a:true", "x:true", "y:true"},
+        {"b:true", "t:true", "z:true"}};
+
+    store.commands(live_config::Key{{"command", "meta"}}, configurations[0]);
+
+    std::atomic<bool> done = false;
+    std::atomic<unsigned long> reloads = 0;
+    std::atomic<unsigned long> lookups = 0;
+    std::atomic<unsigned long> misses = 0;
+
+    std::thread reloader{[&]
+        {
+            for (auto i = 0u; !done; ++i)
+            {
+                store.commands(live_config::Key{{"command", "meta"}}, configurations[i % 2]);
+                ++reloads;
+            }
+        }};
+
+    std::vector<std::thread> lookers;
+    for (auto n = 0u; n != lookup_threads; ++n)
+    {
+        lookers.emplace_back([&]
+            {
+                while (!done)
+                {
+                    auto const modifiers = miriway::Shortcuts::Modifiers::meta;
+                    if (!shortcuts.try_command_for(modifiers, XKB_KEY_t, false, nullptr))
+                        ++misses;
+                    shortcuts.try_command_for(modifiers, XKB_KEY_a, false, nullptr);
+                    shortcuts.try_command_for(modifiers, XKB_KEY_b, false, nullptr);
+                    ++lookups;
+                }
+            });
+    }
+
+    std::this_thread::sleep_for(run_time);
+    done = true;
+
+    reloader.join();
+    for (auto& looker : lookers)
+        looker.join();
+
+    std::printf("%lu reloads, %lu lookups, %lu misses\n", reloads.load(), lookups.load(), misses.load());
+
+    return misses == 0 && reloads > 0 && lookups > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
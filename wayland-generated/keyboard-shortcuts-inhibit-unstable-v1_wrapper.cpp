@@ -0,0 +1,288 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from keyboard-shortcuts-inhibit-unstable-v1.xml by mir_wayland_generator
+ */
+
+#include "keyboard-shortcuts-inhibit-unstable-v1_wrapper.h"
+
+#include <boost/exception/diagnostic_information.hpp>
+#include <wayland-server-core.h>
+
+#include <mir/wayland/protocol_error.h>
+#include <mir/wayland/client.h>
+
+namespace mir
+{
+namespace wayland
+{
+extern struct wl_interface const wl_seat_interface_data;
+extern struct wl_interface const wl_surface_interface_data;
+extern struct wl_interface const zwp_keyboard_shortcuts_inhibit_manager_v1_interface_data;
+extern struct wl_interface const zwp_keyboard_shortcuts_inhibitor_v1_interface_data;
+}
+}
+
+namespace mw = mir::wayland;
+
+namespace
+{
+struct wl_interface const* all_null_types [] {
+    nullptr,
+    nullptr,
+    nullptr};
+}
+
+// KeyboardShortcutsInhibitManagerV1
+
+struct mw::KeyboardShortcutsInhibitManagerV1::Thunks
+{
+    static int const supported_version;
+
+    static void destroy_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        try
+        {
+            auto me = static_cast<KeyboardShortcutsInhibitManagerV1*>(wl_resource_get_user_data(resource));
+            me->destroy();
+            wl_resource_destroy(resource);
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "KeyboardShortcutsInhibitManagerV1::destroy()");
+        }
+    }
+
+    static void inhibit_shortcuts_thunk(struct wl_client* client, struct wl_resource* resource, uint32_t id, struct wl_resource* surface, struct wl_resource* seat)
+    {
+        wl_resource* id_resolved{
+            wl_resource_create(client, &zwp_keyboard_shortcuts_inhibitor_v1_interface_data, wl_resource_get_version(resource), id)};
+        if (id_resolved == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            auto me = static_cast<KeyboardShortcutsInhibitManagerV1*>(wl_resource_get_user_data(resource));
+            me->inhibit_shortcuts(id_resolved, surface, seat);
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "KeyboardShortcutsInhibitManagerV1::inhibit_shortcuts()");
+        }
+    }
+
+    static void resource_destroyed_thunk(wl_resource* resource)
+    {
+        delete static_cast<KeyboardShortcutsInhibitManagerV1*>(wl_resource_get_user_data(resource));
+    }
+
+    static void bind_thunk(struct wl_client* client, void* data, uint32_t version, uint32_t id)
+    {
+        auto me = static_cast<KeyboardShortcutsInhibitManagerV1::Global*>(data);
+        auto resource = wl_resource_create(
+            client,
+            &zwp_keyboard_shortcuts_inhibit_manager_v1_interface_data,
+            std::min((int)version, Thunks::supported_version),
+            id);
+        if (resource == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            me->bind(resource);
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "KeyboardShortcutsInhibitManagerV1 global bind");
+        }
+    }
+
+    static struct wl_interface const* inhibit_shortcuts_types[];
+    static struct wl_message const request_messages[];
+    static void const* request_vtable[];
+};
+
+int const mw::KeyboardShortcutsInhibitManagerV1::Thunks::supported_version = 1;
+
+mw::KeyboardShortcutsInhibitManagerV1::KeyboardShortcutsInhibitManagerV1(struct wl_resource* resource, Version<1>)
+    : Resource{resource}
+{
+    wl_resource_set_implementation(resource, Thunks::request_vtable, this, &Thunks::resource_destroyed_thunk);
+}
+
+mw::KeyboardShortcutsInhibitManagerV1::~KeyboardShortcutsInhibitManagerV1()
+{
+    wl_resource_set_implementation(resource, nullptr, nullptr, nullptr);
+}
+
+bool mw::KeyboardShortcutsInhibitManagerV1::is_instance(wl_resource* resource)
+{
+    return wl_resource_instance_of(resource, &zwp_keyboard_shortcuts_inhibit_manager_v1_interface_data, Thunks::request_vtable);
+}
+
+void mw::KeyboardShortcutsInhibitManagerV1::destroy_and_delete() const
+{
+    // Will result in this object being deleted
+    wl_resource_destroy(resource);
+}
+
+mw::KeyboardShortcutsInhibitManagerV1::Global::Global(wl_display* display, Version<1>)
+    : wayland::Global{
+          wl_global_create(
+              display,
+              &zwp_keyboard_shortcuts_inhibit_manager_v1_interface_data,
+              Thunks::supported_version,
+              this,
+              &Thunks::bind_thunk)}
+{
+}
+
+auto mw::KeyboardShortcutsInhibitManagerV1::Global::interface_name() const -> char const*
+{
+    return KeyboardShortcutsInhibitManagerV1::interface_name;
+}
+
+uint32_t const mw::KeyboardShortcutsInhibitManagerV1::Error::already_inhibited;
+
+struct wl_interface const* mw::KeyboardShortcutsInhibitManagerV1::Thunks::inhibit_shortcuts_types[] {
+    &zwp_keyboard_shortcuts_inhibitor_v1_interface_data,
+    &wl_surface_interface_data,
+    &wl_seat_interface_data};
+
+struct wl_message const mw::KeyboardShortcutsInhibitManagerV1::Thunks::request_messages[] {
+    {"destroy", "", all_null_types},
+    {"inhibit_shortcuts", "noo", inhibit_shortcuts_types}};
+
+void const* mw::KeyboardShortcutsInhibitManagerV1::Thunks::request_vtable[] {
+    (void*)Thunks::destroy_thunk,
+    (void*)Thunks::inhibit_shortcuts_thunk};
+
+mw::KeyboardShortcutsInhibitManagerV1* mw::KeyboardShortcutsInhibitManagerV1::from(struct wl_resource* resource)
+{
+    if (resource &&
+        wl_resource_instance_of(resource, &zwp_keyboard_shortcuts_inhibit_manager_v1_interface_data, KeyboardShortcutsInhibitManagerV1::Thunks::request_vtable))
+    {
+        return static_cast<KeyboardShortcutsInhibitManagerV1*>(wl_resource_get_user_data(resource));
+    }
+    else
+    {
+        return nullptr;
+    }
+}
+
+// KeyboardShortcutsInhibitorV1
+
+struct mw::KeyboardShortcutsInhibitorV1::Thunks
+{
+    static int const supported_version;
+
+    static void destroy_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        try
+        {
+            auto me = static_cast<KeyboardShortcutsInhibitorV1*>(wl_resource_get_user_data(resource));
+            me->destroy();
+            wl_resource_destroy(resource);
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "KeyboardShortcutsInhibitorV1::destroy()");
+        }
+    }
+
+    static void resource_destroyed_thunk(wl_resource* resource)
+    {
+        delete static_cast<KeyboardShortcutsInhibitorV1*>(wl_resource_get_user_data(resource));
+    }
+
+    static struct wl_message const request_messages[];
+    static struct wl_message const event_messages[];
+    static void const* request_vtable[];
+};
+
+int const mw::KeyboardShortcutsInhibitorV1::Thunks::supported_version = 1;
+
+mw::KeyboardShortcutsInhibitorV1::KeyboardShortcutsInhibitorV1(struct wl_resource* resource, Version<1>)
+    : Resource{resource}
+{
+    wl_resource_set_implementation(resource, Thunks::request_vtable, this, &Thunks::resource_destroyed_thunk);
+}
+
+mw::KeyboardShortcutsInhibitorV1::~KeyboardShortcutsInhibitorV1()
+{
+    wl_resource_set_implementation(resource, nullptr, nullptr, nullptr);
+}
+
+void mw::KeyboardShortcutsInhibitorV1::send_active_event() const
+{
+    wl_resource_post_event(resource, Opcode::active);
+}
+
+void mw::KeyboardShortcutsInhibitorV1::send_inactive_event() const
+{
+    wl_resource_post_event(resource, Opcode::inactive);
+}
+
+bool mw::KeyboardShortcutsInhibitorV1::is_instance(wl_resource* resource)
+{
+    return wl_resource_instance_of(resource, &zwp_keyboard_shortcuts_inhibitor_v1_interface_data, Thunks::request_vtable);
+}
+
+struct wl_message const mw::KeyboardShortcutsInhibitorV1::Thunks::request_messages[] {
+    {"destroy", "", all_null_types}};
+
+struct wl_message const mw::KeyboardShortcutsInhibitorV1::Thunks::event_messages[] {
+    {"active", "", all_null_types},
+    {"inactive", "", all_null_types}};
+
+void const* mw::KeyboardShortcutsInhibitorV1::Thunks::request_vtable[] {
+    (void*)Thunks::destroy_thunk};
+
+mw::KeyboardShortcutsInhibitorV1* mw::KeyboardShortcutsInhibitorV1::from(struct wl_resource* resource)
+{
+    if (resource &&
+        wl_resource_instance_of(resource, &zwp_keyboard_shortcuts_inhibitor_v1_interface_data, KeyboardShortcutsInhibitorV1::Thunks::request_vtable))
+    {
+        return static_cast<KeyboardShortcutsInhibitorV1*>(wl_resource_get_user_data(resource));
+    }
+    else
+    {
+        return nullptr;
+    }
+}
+
+namespace mir
+{
+namespace wayland
+{
+
+struct wl_interface const zwp_keyboard_shortcuts_inhibit_manager_v1_interface_data {
+    mw::KeyboardShortcutsInhibitManagerV1::interface_name,
+    mw::KeyboardShortcutsInhibitManagerV1::Thunks::supported_version,
+    2, mw::KeyboardShortcutsInhibitManagerV1::Thunks::request_messages,
+    0, nullptr};
+
+struct wl_interface const zwp_keyboard_shortcuts_inhibitor_v1_interface_data {
+    mw::KeyboardShortcutsInhibitorV1::interface_name,
+    mw::KeyboardShortcutsInhibitorV1::Thunks::supported_version,
+    1, mw::KeyboardShortcutsInhibitorV1::Thunks::request_messages,
+    2, mw::KeyboardShortcutsInhibitorV1::Thunks::event_messages};
+
+}
+}
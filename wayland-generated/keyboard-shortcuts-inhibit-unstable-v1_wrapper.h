@@ -0,0 +1,94 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from keyboard-shortcuts-inhibit-unstable-v1.xml by mir_wayland_generator
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_KEYBOARD_SHORTCUTS_INHIBIT_UNSTABLE_V1_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_KEYBOARD_SHORTCUTS_INHIBIT_UNSTABLE_V1_XML_WRAPPER
+
+#include <optional>
+
+#include <mir/fd.h>
+#include <wayland-server-core.h>
+
+#include <mir/wayland/resource.h>
+#include <mir/wayland/global.h>
+
+namespace mir
+{
+namespace wayland
+{
+
+class KeyboardShortcutsInhibitManagerV1;
+class KeyboardShortcutsInhibitorV1;
+
+class KeyboardShortcutsInhibitManagerV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "zwp_keyboard_shortcuts_inhibit_manager_v1";
+
+    static KeyboardShortcutsInhibitManagerV1* from(struct wl_resource*);
+
+    KeyboardShortcutsInhibitManagerV1(struct wl_resource* resource, Version<1>);
+    virtual ~KeyboardShortcutsInhibitManagerV1();
+
+    void destroy_and_delete() const;
+
+    struct Error
+    {
+        static uint32_t const already_inhibited = 0;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+    class Global : public wayland::Global
+    {
+    public:
+        Global(wl_display* display, Version<1>);
+
+        auto interface_name() const -> char const* override;
+
+    private:
+        virtual void bind(wl_resource* new_zwp_keyboard_shortcuts_inhibit_manager_v1) = 0;
+        friend KeyboardShortcutsInhibitManagerV1::Thunks;
+    };
+
+private:
+    virtual void destroy() {}
+    virtual void inhibit_shortcuts(struct wl_resource* id, struct wl_resource* surface, struct wl_resource* seat) = 0;
+};
+
+class KeyboardShortcutsInhibitorV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "zwp_keyboard_shortcuts_inhibitor_v1";
+
+    static KeyboardShortcutsInhibitorV1* from(struct wl_resource*);
+
+    KeyboardShortcutsInhibitorV1(struct wl_resource* resource, Version<1>);
+    virtual ~KeyboardShortcutsInhibitorV1();
+
+    void send_active_event() const;
+    void send_inactive_event() const;
+
+    struct Opcode
+    {
+        static uint32_t const active = 0;
+        static uint32_t const inactive = 1;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+    virtual void destroy() {}
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_KEYBOARD_SHORTCUTS_INHIBIT_UNSTABLE_V1_XML_WRAPPER